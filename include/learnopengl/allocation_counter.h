@@ -0,0 +1,267 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ALLOCATION_CALLER() _ReturnAddress()
+#else
+#define ALLOCATION_CALLER() __builtin_return_address(0)
+#endif
+
+// Counts the heap allocations made through operator new on the calling
+// thread, to check that a piece of code doesn't allocate:
+//
+//     unsigned long long before = AllocationCounter::count();
+//     mesh.Draw(shader);
+//     assert(AllocationCounter::count() == before);
+//
+// While trackSites is on, allocations on any thread are also added up by
+// the address they were made from, in a fixed table that doesn't allocate
+// itself, to find out what allocates.
+//
+// The replaced operator new and delete are defined by the one source file
+// that includes this header after #define ALLOCATION_COUNTER_IMPLEMENTATION.
+// Plain malloc calls (C libraries, the GL driver) aren't seen.
+class AllocationCounter
+{
+      public:
+	struct Site {
+		const void *caller;
+		unsigned long long count;
+		unsigned long long bytes;
+	};
+
+	static unsigned long long count() { return counts().count; }
+	static unsigned long long bytes() { return counts().bytes; }
+
+	static void trackSites(bool enabled) { tracking() = enabled; }
+	static void clearSites()
+	{
+		for (int i = 0; i < SITE_SLOTS; i++) {
+			slots()[i].count = 0;
+			slots()[i].bytes = 0;
+		}
+	}
+	// copies up to max sites that allocated, most allocations first
+	static size_t sites(Site *out, size_t max)
+	{
+		size_t n = 0;
+		for (int i = 0; i < SITE_SLOTS; i++) {
+			Slot &slot = slots()[i];
+			Site site = {slot.caller.load(), slot.count.load(),
+				     slot.bytes.load()};
+			if (site.count == 0)
+				continue;
+			// insertion into the sorted list, it's short
+			size_t j = n < max ? n++ : max;
+			while (j > 0 && out[j - 1].count < site.count) {
+				if (j < max)
+					out[j] = out[j - 1];
+				j--;
+			}
+			if (j < max)
+				out[j] = site;
+		}
+		return n;
+	}
+	// the function a site is in, or the binary and offset to look it up
+	// with addr2line -f -C -e binary offset when there's no symbol
+	static std::string describe(const void *caller)
+	{
+		char text[512];
+		std::snprintf(text, sizeof(text), "%p", caller);
+#ifndef _WIN32
+		Dl_info info;
+		if (dladdr(caller, &info) && info.dli_sname)
+			std::snprintf(text, sizeof(text), "%s+0x%lx",
+				      info.dli_sname,
+				      (unsigned long)((const char *)caller -
+						      (const char *)
+							  info.dli_saddr));
+		else if (dladdr(caller, &info) && info.dli_fname)
+			std::snprintf(text, sizeof(text), "%s+0x%lx",
+				      info.dli_fname,
+				      (unsigned long)((const char *)caller -
+						      (const char *)
+							  info.dli_fbase));
+#endif
+		return text;
+	}
+
+	// used by the replaced operator new
+	static void *allocate(std::size_t size, const void *caller)
+	{
+		Counts &thread = counts();
+		thread.count++;
+		thread.bytes += size;
+		if (tracking())
+			addSite(caller, size);
+		void *p = std::malloc(size ? size : 1);
+		if (!p)
+			throw std::bad_alloc();
+		return p;
+	}
+
+      private:
+	// a power of two, more sites than this are dropped
+	static const int SITE_SLOTS = 1024;
+
+	struct Counts {
+		unsigned long long count;
+		unsigned long long bytes;
+	};
+	struct Slot {
+		std::atomic<const void *> caller;
+		std::atomic<unsigned long long> count;
+		std::atomic<unsigned long long> bytes;
+	};
+
+	static Counts &counts()
+	{
+		static thread_local Counts threadCounts = {0, 0};
+		return threadCounts;
+	}
+	static std::atomic<bool> &tracking()
+	{
+		static std::atomic<bool> enabled(false);
+		return enabled;
+	}
+	// zero-initialized, so there's no guard to allocate for
+	static Slot *slots()
+	{
+		static Slot table[SITE_SLOTS];
+		return table;
+	}
+
+	// open addressing on the address, slots are claimed once and kept
+	static void addSite(const void *caller, std::size_t size)
+	{
+		uintptr_t hash = (uintptr_t)caller * 0x9E3779B97F4A7C15ull;
+		for (int probe = 0; probe < SITE_SLOTS; probe++) {
+			Slot &slot =
+			    slots()[((hash >> 40) + probe) & (SITE_SLOTS - 1)];
+			const void *owner = slot.caller.load();
+			if (owner == nullptr &&
+			    slot.caller.compare_exchange_strong(owner, caller))
+				owner = caller;
+			if (owner == caller) {
+				slot.count++;
+				slot.bytes += size;
+				return;
+			}
+		}
+	}
+};
+
+// The heap allocations one thread makes per frame, in steady state: the
+// first warmupFrames (compiling shaders, growing buffers to size) aren't
+// counted. A frame's work can be split in several begin/end runs to leave
+// out what runs in between.
+class FrameAllocations
+{
+      public:
+	explicit FrameAllocations(unsigned int warmupFrames)
+	    : warmupFrames(warmupFrames)
+	{
+	}
+
+	void begin()
+	{
+		startCount = AllocationCounter::count();
+		startBytes = AllocationCounter::bytes();
+	}
+	void end()
+	{
+		count += AllocationCounter::count() - startCount;
+		bytes += AllocationCounter::bytes() - startBytes;
+	}
+	// adds up the frame (counted from 0) after its last end()
+	void endFrame(unsigned int frame)
+	{
+		if (frame >= warmupFrames) {
+			frames++;
+			totalCount += count;
+			totalBytes += bytes;
+			if (count > 0)
+				allocatingFrames++;
+			maxCount = std::max(maxCount, count);
+		}
+		count = 0;
+		bytes = 0;
+	}
+
+	unsigned long long total() const { return totalCount; }
+	unsigned long long totalBytesAllocated() const { return totalBytes; }
+	unsigned long long max() const { return maxCount; }
+	unsigned int framesAllocating() const { return allocatingFrames; }
+	double average() const
+	{
+		return frames ? (double)totalCount / frames : 0.0;
+	}
+
+      private:
+	unsigned int warmupFrames;
+	unsigned long long startCount = 0;
+	unsigned long long startBytes = 0;
+	// the current frame
+	unsigned long long count = 0;
+	unsigned long long bytes = 0;
+	unsigned int frames = 0;
+	unsigned int allocatingFrames = 0;
+	unsigned long long totalCount = 0;
+	unsigned long long totalBytes = 0;
+	unsigned long long maxCount = 0;
+};
+
+#ifdef ALLOCATION_COUNTER_IMPLEMENTATION
+void *operator new(std::size_t size)
+{
+	return AllocationCounter::allocate(size, ALLOCATION_CALLER());
+}
+void *operator new[](std::size_t size)
+{
+	return AllocationCounter::allocate(size, ALLOCATION_CALLER());
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	try {
+		return AllocationCounter::allocate(size, ALLOCATION_CALLER());
+	} catch (...) {
+		return nullptr;
+	}
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	try {
+		return AllocationCounter::allocate(size, ALLOCATION_CALLER());
+	} catch (...) {
+		return nullptr;
+	}
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+	std::free(p);
+}
+#endif
+#endif
@@ -0,0 +1,274 @@
+#ifndef ASSET_RELOADER_H
+#define ASSET_RELOADER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/file_watcher.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/texture_array.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Hot reloading of shaders and textures while the app is running. The
+// FileWatcher thread notices edited files: images are decoded right there so
+// the render thread only uploads them, shader sources are just queued since
+// compiling needs the GL context. poll() runs once per frame on the render
+// thread, between frames: it starts rebuilding the shaders that use an
+// edited source and swaps a rebuilt program in once the driver is done
+// with it, which is a later frame where it compiles in the background. A
+// shader that fails to build keeps its previous program.
+class AssetReloader
+{
+      public:
+	AssetReloader()
+	    : watcher([this](const std::string &path) { changed(path); })
+	{
+	}
+
+	AssetReloader(const AssetReloader &) = delete;
+	AssetReloader &operator=(const AssetReloader &) = delete;
+
+	// directories with shader sources, textures watch their own directory
+	void watch(const std::string &directory) { watcher.watch(directory); }
+
+	void addShader(Shader &shader) { shaders.push_back(&shader); }
+	void addShaders(ShaderVariants &family) { variants.push_back(&family); }
+
+	// texture id was loaded from path into target, which is GL_TEXTURE_2D
+	// or one face of a cubemap; flip tells whether the image was loaded
+	// flipped vertically
+	void addTexture(unsigned int id, GLenum target, const std::string &path,
+			bool flip)
+	{
+		TextureSource source = {id, target, nullptr, 0, "", flip};
+		addSource(source, path);
+	}
+
+	// layer of array was decoded from path
+	void addTextureLayer(TextureArray &array, int layer,
+			     const std::string &path)
+	{
+		TextureSource source = {array.ID, GL_TEXTURE_2D_ARRAY, &array,
+					layer, "", true};
+		addSource(source, path);
+	}
+
+	// must be called once all assets are registered, image decoding on
+	// the watcher thread relies on stb_image flipping vertically (the
+	// setting the app keeps outside of loading)
+	void start() { watcher.start(); }
+
+	// applies the pending changes, call on the render thread outside the
+	// timed part of a frame
+	void poll()
+	{
+		CPU_ZONE("AssetReloader::poll");
+		finishBuilds();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (pendingShaders.empty() && pendingTextures.empty())
+				return;
+			pendingShaders.swap(shaderQueue);
+			pendingTextures.swap(textureQueue);
+		}
+		std::vector<Shader *> dependents;
+		for (const std::string &path : shaderQueue) {
+			for (Shader *shader : shaders)
+				if (shader->dependsOn(path))
+					dependents.push_back(shader);
+			for (ShaderVariants *family : variants)
+				family->dependents(path, dependents);
+		}
+		std::sort(dependents.begin(), dependents.end());
+		dependents.erase(
+		    std::unique(dependents.begin(), dependents.end()),
+		    dependents.end());
+		for (Shader *shader : dependents) {
+			// another edit during a rebuild starts it over
+			shader->beginReload();
+			if (std::find(building.begin(), building.end(),
+				      shader) == building.end())
+				building.push_back(shader);
+		}
+		for (const DecodedTexture &texture : textureQueue) {
+			upload(sources[texture.source], texture);
+			std::cout << "Hot reload: "
+				  << sources[texture.source].path << std::endl;
+		}
+		shaderQueue.clear();
+		textureQueue.clear();
+	}
+
+      private:
+	struct TextureSource {
+		unsigned int id;
+		GLenum target;
+		TextureArray *array;
+		int layer;
+		std::string path;
+		bool flip;
+	};
+	struct DecodedTexture {
+		size_t source;
+		std::vector<unsigned char> pixels;
+		int width;
+		int height;
+		int nrComponents;
+	};
+
+	std::vector<Shader *> shaders;
+	std::vector<ShaderVariants *> variants;
+	// shaders rebuilding since an earlier poll(), only used by the render
+	// thread
+	std::vector<Shader *> building;
+	// registered textures, guarded by mutex
+	std::vector<TextureSource> sources;
+	// changes produced by the watcher thread, guarded by mutex
+	std::vector<std::string> pendingShaders;
+	std::vector<DecodedTexture> pendingTextures;
+	// changes being applied by poll(), only used by the render thread
+	std::vector<std::string> shaderQueue;
+	std::vector<DecodedTexture> textureQueue;
+	std::mutex mutex;
+	// declared last so the thread is stopped before the queues go away
+	FileWatcher watcher;
+
+	// swaps in the rebuilt programs the driver is done with
+	void finishBuilds()
+	{
+		for (size_t i = 0; i < building.size();) {
+			Shader *shader = building[i];
+			if (!shader->reloadReady()) {
+				i++;
+				continue;
+			}
+			if (shader->finishReload())
+				std::cout << "Hot reload: " << shader->name()
+					  << std::endl;
+			else
+				std::cout << "Hot reload: " << shader->name()
+					  << " failed to build, keeping the "
+					     "previous program"
+					  << std::endl;
+			building.erase(building.begin() + i);
+		}
+	}
+
+	void addSource(TextureSource source, const std::string &path)
+	{
+		char resolved[PATH_MAX];
+		if (!realpath(path.c_str(), resolved))
+			return;
+		source.path = resolved;
+		std::string directory = source.path.substr(
+		    0, source.path.find_last_of('/'));
+		watcher.watch(directory);
+		std::lock_guard<std::mutex> lock(mutex);
+		sources.push_back(source);
+	}
+
+	// runs on the watcher thread
+	void changed(const std::string &path)
+	{
+		std::vector<TextureSource> matches;
+		std::vector<size_t> indices;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t i = 0; i < sources.size(); i++)
+				if (sources[i].path == path) {
+					matches.push_back(sources[i]);
+					indices.push_back(i);
+				}
+			if (matches.empty()) {
+				// not a texture, maybe a shader source
+				if (std::find(pendingShaders.begin(),
+					      pendingShaders.end(),
+					      path) == pendingShaders.end())
+					pendingShaders.push_back(path);
+				return;
+			}
+		}
+
+		for (size_t i = 0; i < matches.size(); i++) {
+			DecodedTexture texture;
+			texture.source = indices[i];
+			if (!decode(matches[i], texture))
+				continue;
+			std::lock_guard<std::mutex> lock(mutex);
+			pendingTextures.push_back(std::move(texture));
+		}
+	}
+
+	static bool decode(const TextureSource &source, DecodedTexture &texture)
+	{
+		CPU_ZONE("AssetReloader::decode");
+		if (source.array) {
+			texture.width = source.array->width;
+			texture.height = source.array->height;
+			texture.nrComponents = 4;
+			texture.pixels.resize(source.array->layerSize());
+			return source.array->decode(source.path.c_str(),
+						    texture.pixels.data());
+		}
+
+		unsigned char *data =
+		    stbi_load(source.path.c_str(), &texture.width,
+			      &texture.height, &texture.nrComponents, 0);
+		if (!data) {
+			std::cout << "Texture failed to load at path: "
+				  << source.path << std::endl;
+			return false;
+		}
+		size_t row = (size_t)texture.width * texture.nrComponents;
+		texture.pixels.resize(row * texture.height);
+		// stb_image flips globally, undo it for textures that were
+		// loaded unflipped
+		for (int y = 0; y < texture.height; y++) {
+			int srcRow = source.flip ? y : texture.height - 1 - y;
+			std::memcpy(texture.pixels.data() + y * row,
+				    data + srcRow * row, row);
+		}
+		stbi_image_free(data);
+		return true;
+	}
+
+	static void upload(const TextureSource &source,
+			   const DecodedTexture &texture)
+	{
+		if (source.array) {
+			source.array->updateLayer(source.layer,
+						  texture.pixels.data());
+			return;
+		}
+
+		GLenum format = GL_RGB;
+		if (texture.nrComponents == 1)
+			format = GL_RED;
+		else if (texture.nrComponents == 4)
+			format = GL_RGBA;
+		bool cubemap = source.target != GL_TEXTURE_2D;
+		GLenum binding = cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+		// rows of 1 and 3 channel images aren't 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glBindTexture(binding, source.id);
+		glTexImage2D(source.target, 0, format, texture.width,
+			     texture.height, 0, format, GL_UNSIGNED_BYTE,
+			     texture.pixels.data());
+		if (!cubemap)
+			glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(binding, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+};
+#endif
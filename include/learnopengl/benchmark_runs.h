@@ -0,0 +1,52 @@
+#ifndef BENCHMARK_RUNS_H
+#define BENCHMARK_RUNS_H
+
+#include <learnopengl/frame_stats.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// The parts the command-line benchmarks share: the thread counts they go
+// through and the median time of a case run several times.
+//
+//     double ms;
+//     if (!BenchmarkRuns::median(REPETITIONS, [&]() { ...; return ok; }, ms))
+//             report the failure
+class BenchmarkRuns
+{
+      public:
+	// 1, 2, 4, ... up to maxThreads, which is the core count for 0
+	static std::vector<unsigned int> threadCounts(unsigned int maxThreads)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		if (maxThreads == 0)
+			maxThreads = cores > 0 ? cores : 1;
+		std::vector<unsigned int> counts;
+		for (unsigned int t = 1; t < maxThreads; t *= 2)
+			counts.push_back(t);
+		counts.push_back(maxThreads);
+		return counts;
+	}
+
+	// calls run repetitions times and sets ms to the median of how long
+	// the calls took; stops at the first call returning false, which
+	// leaves ms alone and returns false
+	template <typename Run>
+	static bool median(int repetitions, Run run, double &ms)
+	{
+		FrameStats stats;
+		stats.reserve(repetitions);
+		for (int i = 0; i < repetitions; i++) {
+			auto start = std::chrono::steady_clock::now();
+			if (!run())
+				return false;
+			stats.add(std::chrono::duration<double, std::milli>(
+				      std::chrono::steady_clock::now() - start)
+				      .count());
+		}
+		ms = stats.percentile(0.5);
+		return true;
+	}
+};
+#endif
@@ -111,6 +111,16 @@ class Camera
 		updateCameraVectors();
 	}
 
+	// places the camera at position looking along the given Euler angles,
+	// used to play back recorded camera paths
+	void SetPose(glm::vec3 position, float yaw, float pitch)
+	{
+		Position = position;
+		Yaw = yaw;
+		Pitch = pitch;
+		updateCameraVectors();
+	}
+
 	// processes input received from a mouse scroll-wheel event. Only
 	// requires input on the vertical wheel-axis
 	void ProcessMouseScroll(float yoffset)
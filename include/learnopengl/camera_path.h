@@ -0,0 +1,168 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct CameraKey {
+	float time; // seconds from the start of the path
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+};
+
+// A camera path made of keyframes that is played back with a Catmull-Rom
+// spline through the keyframe positions and angles. The path is a text file:
+//
+//   # comment
+//   section <name>
+//   key <time> <x> <y> <z> <yaw> <pitch>
+//
+// keys must be ordered by time. A section starts at the first key after its
+// line and lasts until the next section starts; keys before the first
+// section belong to an unnamed one.
+class CameraPath
+{
+      public:
+	bool load(const std::string &path)
+	{
+		keys.clear();
+		sections.clear();
+		std::ifstream in(path);
+		if (!in) {
+			std::cout << "ERROR::CAMERA_PATH::FILE_NOT_FOUND: "
+				  << path << std::endl;
+			return false;
+		}
+		std::string line;
+		int lineNumber = 0;
+		while (std::getline(in, line)) {
+			lineNumber++;
+			std::istringstream words(line);
+			std::string word;
+			if (!(words >> word) || word[0] == '#')
+				continue;
+			if (word == "section") {
+				Section section;
+				words >> section.name;
+				section.firstKey = keys.size();
+				sections.push_back(section);
+				continue;
+			}
+			CameraKey key;
+			if (word != "key" ||
+			    !(words >> key.time >> key.position.x >>
+			      key.position.y >> key.position.z >> key.yaw >>
+			      key.pitch) ||
+			    (!keys.empty() && key.time < keys.back().time)) {
+				std::cout << "ERROR::CAMERA_PATH::BAD_LINE: "
+					  << path << ":" << lineNumber
+					  << std::endl;
+				return false;
+			}
+			keys.push_back(key);
+		}
+		if (keys.empty()) {
+			std::cout << "ERROR::CAMERA_PATH::NO_KEYS: " << path
+				  << std::endl;
+			return false;
+		}
+		if (sections.empty() || sections[0].firstKey != 0)
+			sections.insert(sections.begin(), Section{"path", 0});
+		return true;
+	}
+
+	float duration() const
+	{
+		return keys.empty() ? 0.0f : keys.back().time;
+	}
+
+	// camera pose at the given time, clamped to the ends of the path
+	CameraKey sample(float time) const
+	{
+		if (time <= keys.front().time)
+			return keys.front();
+		if (time >= keys.back().time)
+			return keys.back();
+		size_t i = 1;
+		while (keys[i].time < time)
+			i++;
+		const CameraKey &k1 = keys[i - 1];
+		const CameraKey &k2 = keys[i];
+		const CameraKey &k0 = i >= 2 ? keys[i - 2] : k1;
+		const CameraKey &k3 = i + 1 < keys.size() ? keys[i + 1] : k2;
+		float span = k2.time - k1.time;
+		float t = span > 0.0f ? (time - k1.time) / span : 1.0f;
+
+		CameraKey key;
+		key.time = time;
+		for (int c = 0; c < 3; c++)
+			key.position[c] =
+			    catmullRom(k0.position[c], k1.position[c],
+				       k2.position[c], k3.position[c], t);
+		key.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, t);
+		key.pitch =
+		    catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t);
+		return key;
+	}
+
+	size_t sectionCount() const { return sections.size(); }
+	const std::string &sectionName(size_t section) const
+	{
+		return sections[section].name;
+	}
+	// pose at the start of a section, a section without keys of its own
+	// starts at the last key
+	const CameraKey &sectionKey(size_t section) const
+	{
+		size_t key = sections[section].firstKey;
+		return keys[key < keys.size() ? key : keys.size() - 1];
+	}
+	// index of the section that contains the given time
+	size_t sectionAt(float time) const
+	{
+		size_t section = 0;
+		for (size_t i = 1; i < sections.size(); i++)
+			if (sections[i].firstKey < keys.size() &&
+			    keys[sections[i].firstKey].time <= time)
+				section = i;
+		return section;
+	}
+
+	// appends a key line to a path file, e.g. to record a path by flying
+	// it and marking poses along the way
+	static bool appendKey(const std::string &path, const CameraKey &key)
+	{
+		std::ofstream out(path, std::ios::app);
+		if (!out)
+			return false;
+		out << "key " << key.time << ' ' << key.position.x << ' '
+		    << key.position.y << ' ' << key.position.z << ' ' << key.yaw
+		    << ' ' << key.pitch << '\n';
+		return true;
+	}
+
+      private:
+	struct Section {
+		std::string name;
+		size_t firstKey;
+	};
+
+	std::vector<CameraKey> keys;
+	std::vector<Section> sections;
+
+	static float catmullRom(float p0, float p1, float p2, float p3, float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+		return 0.5f * (2.0f * p1 + (p2 - p0) * t +
+			       (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			       (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	}
+};
+#endif
@@ -0,0 +1,215 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped CPU zones recorded into per-thread buffers and exported in the
+// Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+//
+// Recording is lock-free: every thread appends to its own fixed-size buffer
+// and publishes the new event count with a release store, the exporter only
+// reads events below that count. A capture is identified by a generation
+// number; a thread that sees a new generation starts its buffer over, so
+// buffers never have to be cleared from another thread. While no capture is
+// running a zone costs one relaxed atomic load.
+class CpuProfiler
+{
+      public:
+	// events kept per thread and capture, later ones are dropped
+	static const size_t EVENTS_PER_THREAD = 1 << 16;
+
+	// records the time between construction and destruction, name must
+	// stay valid until the capture is written (a literal)
+	class Zone
+	{
+	      public:
+		explicit Zone(const char *name)
+		    : name(name), active(capturing()), start(active ? now() : 0)
+		{
+		}
+		~Zone()
+		{
+			if (active)
+				record(name, start, now());
+		}
+		Zone(const Zone &) = delete;
+		Zone &operator=(const Zone &) = delete;
+
+	      private:
+		const char *name;
+		bool active;
+		unsigned long long start;
+	};
+
+	// starts a new capture, events of a previous one are discarded
+	static void start()
+	{
+		State &s = state();
+		s.generation.fetch_add(1);
+		s.capturing.store(true);
+	}
+
+	static bool capturing()
+	{
+		return state().capturing.load(std::memory_order_relaxed);
+	}
+
+	// ends the capture and writes it as trace JSON to path
+	static bool stop(const std::string &path)
+	{
+		State &s = state();
+		s.capturing.store(false);
+		unsigned int generation = s.generation.load();
+
+		FILE *out = std::fopen(path.c_str(), "w");
+		if (!out) {
+			std::cout << "ERROR::CPU_PROFILER::CANNOT_WRITE: "
+				  << path << std::endl;
+			return false;
+		}
+		std::fprintf(out,
+			     "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		size_t written = 0;
+		unsigned long long dropped = 0;
+		std::lock_guard<std::mutex> lock(s.mutex);
+		for (size_t tid = 0; tid < s.threads.size(); tid++) {
+			ThreadBuffer &buffer = *s.threads[tid];
+			std::fprintf(out,
+				     "%s\n{\"name\":\"thread_name\","
+				     "\"ph\":\"M\",\"pid\":1,\"tid\":%zu,"
+				     "\"args\":{\"name\":\"%s\"}}",
+				     tid == 0 ? "" : ",", tid,
+				     buffer.name.c_str());
+			if (buffer.generation.load(std::memory_order_acquire) !=
+			    generation)
+				continue;
+			size_t count =
+			    buffer.count.load(std::memory_order_acquire);
+			for (size_t i = 0; i < count; i++) {
+				const Event &e = buffer.events[i];
+				std::fprintf(out,
+					     ",\n{\"name\":\"%s\","
+					     "\"cat\":\"cpu\",\"ph\":\"X\","
+					     "\"pid\":1,\"tid\":%zu,"
+					     "\"ts\":%.3f,\"dur\":%.3f}",
+					     e.name, tid, e.start / 1000.0,
+					     (e.end - e.start) / 1000.0);
+			}
+			written += count;
+			dropped += buffer.dropped.load();
+		}
+		std::fprintf(out, "\n]}\n");
+		std::fclose(out);
+		std::cout << "CpuProfiler: wrote " << written << " events to "
+			  << path;
+		if (dropped)
+			std::cout << " (" << dropped
+				  << " dropped, buffers full)";
+		std::cout << std::endl;
+		return true;
+	}
+
+	// name shown for the calling thread in the trace
+	static void setThreadName(const std::string &name)
+	{
+		ThreadBuffer &buffer = threadBuffer();
+		std::lock_guard<std::mutex> lock(state().mutex);
+		buffer.name = name;
+	}
+
+	// nanoseconds since the profiler was first used
+	static unsigned long long now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now() - state().epoch)
+		    .count();
+	}
+
+      private:
+	struct Event {
+		const char *name;
+		unsigned long long start;
+		unsigned long long end;
+	};
+
+	struct ThreadBuffer {
+		std::unique_ptr<Event[]> events;
+		std::atomic<size_t> count{0};
+		std::atomic<unsigned int> generation{0};
+		std::atomic<unsigned long long> dropped{0};
+		std::string name;
+	};
+
+	struct State {
+		std::chrono::steady_clock::time_point epoch =
+		    std::chrono::steady_clock::now();
+		std::atomic<bool> capturing{false};
+		std::atomic<unsigned int> generation{0};
+		// guards the list of buffers and thread names, not the events
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> threads;
+	};
+
+	static State &state()
+	{
+		static State s;
+		return s;
+	}
+
+	// buffers outlive their threads so a capture can still be written
+	// after a worker exited
+	static ThreadBuffer &threadBuffer()
+	{
+		static thread_local ThreadBuffer *buffer = nullptr;
+		if (!buffer) {
+			State &s = state();
+			std::lock_guard<std::mutex> lock(s.mutex);
+			s.threads.emplace_back(new ThreadBuffer);
+			buffer = s.threads.back().get();
+			buffer->name =
+			    "thread " + std::to_string(s.threads.size() - 1);
+		}
+		return *buffer;
+	}
+
+	static void record(const char *name, unsigned long long start,
+			   unsigned long long end)
+	{
+		State &s = state();
+		if (!s.capturing.load(std::memory_order_relaxed))
+			return;
+		ThreadBuffer &buffer = threadBuffer();
+		unsigned int generation = s.generation.load();
+		if (buffer.generation.load(std::memory_order_relaxed) !=
+		    generation) {
+			if (!buffer.events)
+				buffer.events.reset(
+				    new Event[EVENTS_PER_THREAD]);
+			buffer.count.store(0, std::memory_order_relaxed);
+			buffer.dropped.store(0, std::memory_order_relaxed);
+			buffer.generation.store(generation,
+						std::memory_order_release);
+		}
+		size_t count = buffer.count.load(std::memory_order_relaxed);
+		if (count == EVENTS_PER_THREAD) {
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		buffer.events[count] = {name, start, end};
+		buffer.count.store(count + 1, std::memory_order_release);
+	}
+};
+
+#define CPU_PROFILER_CONCAT_(a, b) a##b
+#define CPU_PROFILER_CONCAT(a, b) CPU_PROFILER_CONCAT_(a, b)
+// times the rest of the enclosing scope as a zone called name
+#define CPU_ZONE(name)                                                         \
+	CpuProfiler::Zone CPU_PROFILER_CONCAT(cpuZone, __LINE__)(name)
+#endif
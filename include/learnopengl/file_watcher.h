@@ -0,0 +1,147 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <learnopengl/cpu_profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Watches directories (not recursively) and reports files that were written
+// or replaced from a background thread. Editors often save by writing a
+// temporary file and renaming it over the original, so a file closed after
+// writing and a file moved into the directory both count as a change. Only
+// inotify is implemented; elsewhere watch() fails and nothing is reported.
+class FileWatcher
+{
+      public:
+	// onChange is called on the watcher thread with the canonical path of
+	// every changed file
+	explicit FileWatcher(std::function<void(const std::string &)> onChange)
+	    : onChange(onChange)
+	{
+#ifdef __linux__
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd == -1)
+			std::cout << "ERROR::FILE_WATCHER::INOTIFY_INIT_FAILED"
+				  << std::endl;
+#endif
+	}
+
+	~FileWatcher()
+	{
+		stop();
+#ifdef __linux__
+		if (fd != -1)
+			close(fd);
+#endif
+	}
+
+	FileWatcher(const FileWatcher &) = delete;
+	FileWatcher &operator=(const FileWatcher &) = delete;
+
+	// starts watching a directory, may be called before or after start();
+	// watching the same directory again does nothing
+	bool watch(const std::string &directory)
+	{
+		char resolved[PATH_MAX];
+		if (!realpath(directory.c_str(), resolved)) {
+			std::cout << "ERROR::FILE_WATCHER::NO_SUCH_DIRECTORY: "
+				  << directory << std::endl;
+			return false;
+		}
+#ifdef __linux__
+		if (fd == -1)
+			return false;
+		std::lock_guard<std::mutex> lock(mutex);
+		int wd = inotify_add_watch(fd, resolved,
+					   IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (wd == -1) {
+			std::cout << "ERROR::FILE_WATCHER::WATCH_FAILED: "
+				  << directory << std::endl;
+			return false;
+		}
+		directories[wd] = resolved;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void start()
+	{
+		if (running)
+			return;
+		running = true;
+		thread = std::thread(&FileWatcher::run, this);
+	}
+
+	void stop()
+	{
+		running = false;
+		if (thread.joinable())
+			thread.join();
+	}
+
+      private:
+	std::function<void(const std::string &)> onChange;
+	std::atomic<bool> running{false};
+	std::thread thread;
+	std::mutex mutex;
+	// watch descriptor -> canonical directory
+	std::map<int, std::string> directories;
+	int fd = -1;
+
+	void run()
+	{
+		CpuProfiler::setThreadName("file watcher");
+#ifdef __linux__
+		alignas(struct inotify_event) char buffer[4096];
+		std::vector<std::string> changed;
+		while (running) {
+			// wake up regularly to notice stop()
+			struct pollfd pfd = {fd, POLLIN, 0};
+			if (poll(&pfd, 1, 100) <= 0)
+				continue;
+			ssize_t length = read(fd, buffer, sizeof(buffer));
+			if (length <= 0)
+				continue;
+
+			// a single save can produce several events for the
+			// same file, report it once per batch
+			changed.clear();
+			std::unique_lock<std::mutex> lock(mutex);
+			for (char *p = buffer; p < buffer + length;) {
+				struct inotify_event *event =
+				    (struct inotify_event *)p;
+				p += sizeof(struct inotify_event) + event->len;
+				if (event->len == 0 ||
+				    directories.count(event->wd) == 0)
+					continue;
+				std::string path =
+				    directories[event->wd] + "/" + event->name;
+				if (std::find(changed.begin(), changed.end(),
+					      path) == changed.end())
+					changed.push_back(path);
+			}
+			lock.unlock();
+			for (const std::string &path : changed)
+				onChange(path);
+		}
+#endif
+	}
+};
+#endif
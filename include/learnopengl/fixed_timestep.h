@@ -0,0 +1,96 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <glm/glm.hpp>
+
+// Runs the simulation in steps of a fixed length, independent of the frame
+// rate. Every frame adds its time to an accumulator and advance() returns
+// how many whole steps fit; the remainder carries over, so over time the
+// simulation runs exactly as long as the frames took. A frame is rendered
+// from state interpolated between the last two steps by alpha().
+//
+// A frame that took too long (a stall, a breakpoint) would otherwise need
+// ever more steps to catch up; at most maxSteps run per frame and the rest
+// of the time is dropped.
+class FixedTimestep
+{
+      public:
+	// seconds per step
+	float step;
+	unsigned int maxSteps;
+
+	explicit FixedTimestep(float step = 1.0f / 120.0f,
+			       unsigned int maxSteps = 8)
+	    : step(step), maxSteps(maxSteps)
+	{
+	}
+
+	// adds a frame's time and returns the number of steps to run
+	unsigned int advance(float frameTime)
+	{
+		accumulator += frameTime;
+		unsigned int steps = (unsigned int)(accumulator / step);
+		if (steps > maxSteps) {
+			droppedTime += accumulator - maxSteps * step;
+			steps = maxSteps;
+			accumulator = maxSteps * step;
+		}
+		accumulator -= steps * step;
+
+		frames++;
+		totalSteps += steps;
+		lastSteps = steps;
+		if (steps > mostSteps)
+			mostSteps = steps;
+		return steps;
+	}
+
+	// where the frame lies between the previous and the last step, in
+	// [0, 1)
+	float alpha() const { return (float)(accumulator / step); }
+	// time the simulation is behind the frame, less than a step
+	float remainder() const { return (float)accumulator; }
+
+	glm::vec3 interpolate(const glm::vec3 &previous,
+			      const glm::vec3 &current) const
+	{
+		return glm::mix(previous, current, alpha());
+	}
+
+	// distance between the rendered state and the state the simulation
+	// would have at the frame's time, for the stats
+	void addInterpolationError(float error)
+	{
+		errorSum += error;
+		errorCount++;
+		if (error > errorMax)
+			errorMax = error;
+	}
+
+	unsigned int lastStepCount() const { return lastSteps; }
+	unsigned int maxStepCount() const { return mostSteps; }
+	unsigned long long stepCount() const { return totalSteps; }
+	float averageStepCount() const
+	{
+		return frames ? (float)totalSteps / frames : 0.0f;
+	}
+	// seconds the step limit skipped
+	double dropped() const { return droppedTime; }
+	float averageInterpolationError() const
+	{
+		return errorCount ? (float)(errorSum / errorCount) : 0.0f;
+	}
+	float maxInterpolationError() const { return errorMax; }
+
+      private:
+	double accumulator = 0.0;
+	double droppedTime = 0.0;
+	unsigned long long frames = 0;
+	unsigned long long totalSteps = 0;
+	unsigned int lastSteps = 0;
+	unsigned int mostSteps = 0;
+	double errorSum = 0.0;
+	unsigned long long errorCount = 0;
+	float errorMax = 0.0f;
+};
+#endif
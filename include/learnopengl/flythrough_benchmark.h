@@ -0,0 +1,111 @@
+#ifndef FLYTHROUGH_BENCHMARK_H
+#define FLYTHROUGH_BENCHMARK_H
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_path.h>
+#include <learnopengl/frame_stats.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Flies the camera along a CameraPath for a fixed number of frames and
+// collects frame times per path section. Frame i is posed at a fixed point
+// of the path (not at the wall-clock time), so every run renders exactly the
+// same images regardless of how fast it goes. The path's first pose is
+// rendered a few extra frames before measuring so shader variants and
+// driver warm-up don't land in the first section.
+class FlythroughBenchmark
+{
+      public:
+	static const unsigned int WARMUP_FRAMES = 10;
+
+	bool load(const std::string &pathFile, unsigned int frames)
+	{
+		this->pathFile = pathFile;
+		this->frames = frames < 2 ? 2 : frames;
+		if (!path.load(pathFile))
+			return false;
+		sections.assign(path.sectionCount(), FrameStats());
+		// the measured frames don't allocate
+		for (FrameStats &section : sections)
+			section.reserve(this->frames);
+		all.reserve(this->frames);
+		return true;
+	}
+
+	// frames to render including the warm-up
+	unsigned int totalFrames() const { return WARMUP_FRAMES + frames; }
+
+	// poses the camera for frame (counted from 0)
+	void apply(unsigned int frame, Camera &camera) const
+	{
+		CameraKey key = path.sample(timeOf(frame));
+		camera.SetPose(key.position, key.yaw, key.pitch);
+	}
+
+	void addFrameTime(unsigned int frame, double ms)
+	{
+		if (frame < WARMUP_FRAMES)
+			return;
+		sections[path.sectionAt(timeOf(frame))].add(ms);
+		all.add(ms);
+	}
+
+	bool writeJson(const std::string &file, const std::string &renderer,
+		       unsigned int width, unsigned int height) const
+	{
+		FILE *out = std::fopen(file.c_str(), "w");
+		if (!out) {
+			std::cout << "ERROR::BENCHMARK::CANNOT_WRITE: " << file
+				  << std::endl;
+			return false;
+		}
+		std::fprintf(out,
+			     "{\n  \"path\": \"%s\",\n  \"renderer\": \"%s\","
+			     "\n  \"width\": %u,\n  \"height\": %u,\n"
+			     "  \"frames\": %u,\n  \"sections\": [\n",
+			     pathFile.c_str(), renderer.c_str(), width, height,
+			     frames);
+		for (size_t i = 0; i < sections.size(); i++) {
+			writeStats(out, path.sectionName(i), sections[i]);
+			std::fprintf(out, i + 1 < sections.size() ? ",\n"
+								  : "\n");
+		}
+		std::fprintf(out, "  ],\n  \"total\":\n");
+		writeStats(out, "total", all);
+		std::fprintf(out, "\n}\n");
+		std::fclose(out);
+		return true;
+	}
+
+      private:
+	CameraPath path;
+	std::string pathFile;
+	unsigned int frames = 0;
+	std::vector<FrameStats> sections;
+	FrameStats all;
+
+	float timeOf(unsigned int frame) const
+	{
+		if (frame < WARMUP_FRAMES)
+			return 0.0f;
+		return path.duration() * (frame - WARMUP_FRAMES) /
+		       (frames - 1);
+	}
+
+	static void writeStats(FILE *out, const std::string &name,
+			       const FrameStats &stats)
+	{
+		std::fprintf(out,
+			     "    {\"name\": \"%s\", \"frames\": %zu, "
+			     "\"min_ms\": %.3f, \"avg_ms\": %.3f, "
+			     "\"p95_ms\": %.3f, \"p99_ms\": %.3f, "
+			     "\"max_ms\": %.3f}",
+			     name.c_str(), stats.count(), stats.min(),
+			     stats.average(), stats.percentile(0.95),
+			     stats.percentile(0.99), stats.max());
+	}
+};
+#endif
@@ -0,0 +1,92 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A linear allocator for scratch data that only lives for one frame:
+// allocations bump an offset through a block and reset() frees them all at
+// once, without going to the heap. A frame that needs more than the block
+// chains extra blocks from the heap, and the next reset() swaps them for one
+// block big enough for that frame, so the arena stops allocating once it has
+// seen its largest frame. Not thread-safe, every thread owns its own arena.
+class FrameArena
+{
+      public:
+	explicit FrameArena(size_t capacity = 64 * 1024)
+	{
+		addBlock(capacity);
+	}
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator=(const FrameArena &) = delete;
+
+	// alignment is a power of two, at most alignof(std::max_align_t)
+	void *allocate(size_t size,
+		       size_t alignment = alignof(std::max_align_t))
+	{
+		size_t start = (offset + alignment - 1) & ~(alignment - 1);
+		if (start + size > blocks.back().size) {
+			addBlock(std::max(size, blocks.back().size * 2));
+			start = 0;
+		}
+		offset = start + size;
+		used += size;
+		return blocks.back().data.get() + start;
+	}
+
+	// count uninitialized Ts; nothing in the arena is ever destroyed
+	template <typename T> T *allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value,
+			      "the arena doesn't run destructors");
+		return static_cast<T *>(
+		    allocate(count * sizeof(T), alignof(T)));
+	}
+
+	// frees this frame's allocations, call once per frame
+	void reset()
+	{
+		if (blocks.size() > 1) {
+			size_t total = 0;
+			for (const Block &block : blocks)
+				total += block.size;
+			blocks.clear();
+			addBlock(total);
+		}
+		offset = 0;
+		used = 0;
+	}
+
+	// bytes handed out since the last reset
+	size_t bytesUsed() const { return used; }
+	size_t capacity() const
+	{
+		size_t total = 0;
+		for (const Block &block : blocks)
+			total += block.size;
+		return total;
+	}
+
+      private:
+	struct Block {
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+	// into the last block
+	size_t offset = 0;
+	size_t used = 0;
+
+	void addBlock(size_t size)
+	{
+		Block block = {std::unique_ptr<char[]>(new char[size]), size};
+		blocks.push_back(std::move(block));
+		offset = 0;
+	}
+};
+#endif
@@ -0,0 +1,247 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/frame_arena.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+enum VsyncMode { VSYNC_OFF, VSYNC_ON, VSYNC_ADAPTIVE, VSYNC_MODE_COUNT };
+
+const char *const VSYNC_MODE_NAMES[VSYNC_MODE_COUNT] = {"Off", "On",
+							"Adaptive"};
+
+// Paces frames and estimates their latency.
+//
+// - vsync picks the swap interval; adaptive vsync (swap_control_tear)
+//   tears instead of waiting a whole refresh when a frame is late and
+//   falls back to plain vsync where the driver lacks it.
+// - fpsLimit > 0 starts frames at most that often. The limiter sleeps
+//   until shortly before the deadline and spins the rest, sleeps alone
+//   overshoot by up to a scheduler tick.
+// - lowLatency waits for the GPU to finish the previous frame before the
+//   next one reads input, so the CPU can't queue frames ahead of the GPU
+//   and every frame shows the newest input, at the cost of CPU/GPU
+//   overlap.
+//
+// Input may be read on another thread than the one rendering: the limiter
+// and the settings belong to the input thread, the fence, the queries and
+// the latency statistics to the GL thread.
+//
+// Latency is measured from the moment a frame reads input to the moment
+// the GPU is done with it (including the swap), using a GL_TIMESTAMP query
+// written after the frame and converted to the CPU clock. The time until
+// the image is scanned out is not visible to GL and is not included.
+class FramePacer
+{
+      public:
+	// timestamp queries in flight, a result is read when available
+	static const int LATENCY_QUERIES = 4;
+	// latency samples kept for the statistics
+	static const int HISTORY = 240;
+
+	VsyncMode vsync = VSYNC_ON;
+	// set by the caller when the window system has swap_control_tear
+	bool adaptiveSupported = false;
+	// frames per second, 0 for no limit
+	float fpsLimit = 0.0f;
+	bool lowLatency = false;
+
+	FramePacer() = default;
+	FramePacer(const FramePacer &) = delete;
+	FramePacer &operator=(const FramePacer &) = delete;
+
+	// for glfwSwapInterval
+	int swapInterval() const
+	{
+		if (vsync == VSYNC_OFF)
+			return 0;
+		if (vsync == VSYNC_ADAPTIVE && adaptiveSupported)
+			return -1;
+		return 1;
+	}
+
+	// waits for the frame limiter, call on the thread that reads input
+	void beginFrame()
+	{
+		waitStart = now();
+		if (fpsLimit > 0.0f) {
+			long long interval = (long long)(1.0e9 / fpsLimit);
+			// after a long frame start over rather than rush
+			// to catch up
+			if (deadline == 0 || waitStart > deadline + interval)
+				deadline = waitStart;
+			waitUntil(deadline);
+			deadline += interval;
+		} else {
+			deadline = 0;
+		}
+	}
+
+	// in low-latency mode waits until the GPU finished the frame that
+	// endFrame was last called for, call on the GL thread
+	void waitForGpu()
+	{
+		if (!fence)
+			return;
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+				 FENCE_TIMEOUT);
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	// call right before the frame reads its input, returns the time to
+	// pass to endFrame
+	long long inputRead()
+	{
+		long long inputTime = now();
+		lastWait = (inputTime - waitStart) / 1.0e6f;
+		return inputTime;
+	}
+
+	// call on the GL thread once the frame is submitted (after the
+	// swap), addFence in low-latency mode
+	void endFrame(long long inputTime, bool addFence)
+	{
+		if (queries.empty()) {
+			queries.resize(LATENCY_QUERIES);
+			glGenQueries(LATENCY_QUERIES, queries.data());
+			queryInputTimes.assign(LATENCY_QUERIES, 0);
+			history.reserve(HISTORY);
+		}
+		if (frames++ % CALIBRATION_INTERVAL == 0)
+			calibrate();
+		collect();
+		if (queryInputTimes[next] == 0) {
+			glQueryCounter(queries[next], GL_TIMESTAMP);
+			queryInputTimes[next] = inputTime;
+			next = (next + 1) % LATENCY_QUERIES;
+		}
+		if (addFence)
+			fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	// milliseconds from beginFrame to inputRead of the last frame
+	float waitTime() const { return lastWait; }
+	float latencyAverage() const
+	{
+		float sum = 0.0f;
+		for (float ms : history)
+			sum += ms;
+		return history.empty() ? 0.0f : sum / history.size();
+	}
+	float latencyPercentile(float p) const
+	{
+		std::vector<float> sorted(history);
+		return percentile(sorted.data(), sorted.size(), p);
+	}
+	// the same with the sorted copy in a frame arena, for every frame
+	float latencyPercentile(float p, FrameArena &arena) const
+	{
+		float *sorted = arena.allocate<float>(history.size());
+		std::copy(history.begin(), history.end(), sorted);
+		return percentile(sorted, history.size(), p);
+	}
+
+	void clear()
+	{
+		if (!queries.empty())
+			glDeleteQueries(LATENCY_QUERIES, queries.data());
+		queries.clear();
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+      private:
+	// frames between re-syncing the GPU clock to the CPU clock
+	static const unsigned int CALIBRATION_INTERVAL = 60;
+	// spin instead of sleeping this close to a deadline
+	static const long long SPIN_NS = 2000000;
+	static const GLuint64 FENCE_TIMEOUT = 100000000;
+
+	// used on the thread that reads input
+	long long deadline = 0;
+	long long waitStart = 0;
+	float lastWait = 0.0f;
+
+	// used on the GL thread
+	GLsync fence = nullptr;
+
+	std::vector<GLuint> queries;
+	// input time of the frame each query belongs to, 0 when free
+	std::vector<long long> queryInputTimes;
+	int next = 0;
+	unsigned int frames = 0;
+	// CPU time minus GPU time
+	long long clockOffset = 0;
+
+	std::vector<float> history;
+	size_t historyNext = 0;
+
+	static long long now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		    .count();
+	}
+
+	// nearest rank, sorts values
+	static float percentile(float *values, size_t count, float p)
+	{
+		if (count == 0)
+			return 0.0f;
+		std::sort(values, values + count);
+		size_t rank = (size_t)(p * count);
+		return values[std::min(rank, count - 1)];
+	}
+
+	static void waitUntil(long long time)
+	{
+		long long left = time - now();
+		if (left > SPIN_NS)
+			std::this_thread::sleep_for(
+			    std::chrono::nanoseconds(left - SPIN_NS));
+		while (now() < time)
+			std::this_thread::yield();
+	}
+
+	void calibrate()
+	{
+		GLint64 gpu = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpu);
+		clockOffset = now() - gpu;
+	}
+
+	void collect()
+	{
+		for (int i = 0; i < LATENCY_QUERIES; i++) {
+			if (queryInputTimes[i] == 0)
+				continue;
+			GLint available = 0;
+			glGetQueryObjectiv(queries[i],
+					   GL_QUERY_RESULT_AVAILABLE,
+					   &available);
+			if (!available)
+				continue;
+			GLuint64 gpu = 0;
+			glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT,
+					      &gpu);
+			float ms = ((long long)gpu + clockOffset -
+				    queryInputTimes[i]) /
+				   1.0e6f;
+			queryInputTimes[i] = 0;
+			if (history.size() < HISTORY) {
+				history.push_back(ms);
+			} else {
+				history[historyNext] = ms;
+				historyNext = (historyNext + 1) % HISTORY;
+			}
+		}
+	}
+};
+#endif
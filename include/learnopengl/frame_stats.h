@@ -0,0 +1,58 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <algorithm>
+#include <vector>
+
+// Collects frame times (in milliseconds) and summarizes them. Percentiles
+// use the nearest-rank method on a sorted copy, so summaries are meant for
+// the end of a run, not for every frame.
+class FrameStats
+{
+      public:
+	void add(double ms) { samples.push_back(ms); }
+	// room for count samples, so that adding them doesn't allocate
+	void reserve(size_t count) { samples.reserve(count); }
+	void clear() { samples.clear(); }
+	size_t count() const { return samples.size(); }
+
+	double total() const
+	{
+		double sum = 0.0;
+		for (double ms : samples)
+			sum += ms;
+		return sum;
+	}
+	double average() const
+	{
+		return samples.empty() ? 0.0 : total() / samples.size();
+	}
+	double min() const
+	{
+		return samples.empty()
+			   ? 0.0
+			   : *std::min_element(samples.begin(), samples.end());
+	}
+	double max() const
+	{
+		return samples.empty()
+			   ? 0.0
+			   : *std::max_element(samples.begin(), samples.end());
+	}
+	// p in [0, 1]
+	double percentile(double p) const
+	{
+		if (samples.empty())
+			return 0.0;
+		std::vector<double> sorted(samples);
+		std::sort(sorted.begin(), sorted.end());
+		size_t rank = (size_t)(p * sorted.size());
+		if (rank >= sorted.size())
+			rank = sorted.size() - 1;
+		return sorted[rank];
+	}
+
+      private:
+	std::vector<double> samples;
+};
+#endif
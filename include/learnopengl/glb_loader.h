@@ -0,0 +1,512 @@
+#ifndef GLB_LOADER_H
+#define GLB_LOADER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/json.h>
+#include <learnopengl/mapped_file.h>
+#include <learnopengl/mesh.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// a range of the binary chunk
+struct GlbBufferView {
+	size_t offset;
+	size_t length;
+	// bytes between vertices, 0 when tightly packed
+	size_t stride;
+};
+
+// an attribute of a primitive as glVertexAttribPointer reads it from the
+// GL buffer holding its buffer view
+struct GlbAttribute {
+	GLuint location;
+	GLint size;
+	GLenum type;
+	GLboolean normalized;
+	GLsizei stride;
+	size_t offset;
+	int view;
+};
+
+// one draw call: a glTF primitive placed by the node referencing its mesh
+struct GlbPrimitive {
+	std::vector<GlbAttribute> attributes;
+	// -1 for a primitive without indices
+	int indexView = -1;
+	size_t indexOffset = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+	// indices, or vertices without them
+	unsigned int count = 0;
+	unsigned int vertexCount = 0;
+	// index into GlbLoader::materials, -1 for none
+	int material = -1;
+	glm::mat4 transform = glm::mat4(1.0f);
+	// the POSITION accessor's min and max, as the vertex shader reads
+	// them (before transform)
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+// the images of a material for the texture slots Mesh::Draw binds, indices
+// into GlbLoader::images or -1
+struct GlbMaterial {
+	int diffuse = -1;  // pbrMetallicRoughness.baseColorTexture
+	int specular = -1; // KHR_materials_specular specularTexture
+	int normal = -1;   // normalTexture
+};
+
+// an encoded image, either inside the file or next to it
+struct GlbImage {
+	// into the binary chunk, nullptr for an image referenced by uri
+	const unsigned char *data = nullptr;
+	size_t size = 0;
+	std::string uri;
+};
+
+// Reads binary glTF 2.0 (.glb) files for upload without converting any
+// vertices: the file is memory-mapped and the buffer views holding vertex
+// attributes and indices are meant to go to GL as they are, one buffer each,
+// with the accessors turned into glVertexAttribPointer calls. Interleaved
+// views (byteStride) and quantized attributes (KHR_mesh_quantization:
+// normalized or integer bytes and shorts) are what glVertexAttribPointer
+// takes anyway; the node transforms that undo the quantization end up in
+// GlbPrimitive::transform.
+//
+// Attributes are bound to Mesh's locations: POSITION 0, NORMAL 1,
+// TEXCOORD_0 2 and TANGENT 3 (xyzw, Mesh's bitangent stays unset). Only
+// triangle lists are drawn; sparse accessors, external .bin buffers and
+// data: URIs aren't supported.
+//
+// The data pointers stay valid until the loader is destroyed or loads
+// another file.
+class GlbLoader
+{
+      public:
+	std::vector<GlbBufferView> views;
+	std::vector<GlbPrimitive> primitives;
+	std::vector<GlbMaterial> materials;
+	std::vector<GlbImage> images;
+
+	bool load(const std::string &path)
+	{
+		CPU_ZONE("GlbLoader::load");
+		views.clear();
+		primitives.clear();
+		materials.clear();
+		images.clear();
+		geometry.clear();
+		bin = nullptr;
+		binSize = 0;
+		if (!file.open(path)) {
+			std::cout << "ERROR::GLB::FILE_NOT_FOUND: " << path
+				  << std::endl;
+			return false;
+		}
+		const char *json = nullptr;
+		size_t jsonSize = 0;
+		if (!readChunks(json, jsonSize)) {
+			std::cout << "ERROR::GLB::INVALID_FILE: " << path
+				  << std::endl;
+			return false;
+		}
+		JsonValue root;
+		std::string error;
+		if (!JsonValue::parse(json, json + jsonSize, root, error)) {
+			std::cout << "ERROR::GLB::INVALID_JSON: " << path
+				  << ": " << error << std::endl;
+			return false;
+		}
+		const JsonValue &required = root["extensionsRequired"];
+		for (size_t i = 0; i < required.size(); i++) {
+			const std::string &name = required[i].string();
+			if (name != "KHR_mesh_quantization") {
+				std::cout
+				    << "ERROR::GLB::UNSUPPORTED_EXTENSION: "
+				    << name << std::endl;
+				return false;
+			}
+		}
+		if (!readViews(root))
+			return false;
+		readImages(root);
+		readMaterials(root);
+
+		// the default scene, or all root nodes of the first one
+		const JsonValue &scene =
+		    root["scenes"][root["scene"].integer()];
+		const JsonValue &nodes = scene["nodes"];
+		for (size_t i = 0; i < nodes.size(); i++)
+			addNode(root, nodes[i].integer(-1), glm::mat4(1.0f), 0);
+		return true;
+	}
+
+	// the views that primitives read from, in ascending order; only
+	// these need a GL buffer
+	const std::vector<int> &geometryViews() const { return geometry; }
+
+	const unsigned char *viewData(int view) const
+	{
+		return bin + views[view].offset;
+	}
+
+      private:
+	static const uint32_t MAGIC = 0x46546C67; // "glTF"
+	static const uint32_t CHUNK_JSON = 0x4E4F534A;
+	static const uint32_t CHUNK_BIN = 0x004E4942;
+	// node hierarchies deeper than this are cut off
+	static const int MAX_DEPTH = 64;
+
+	MappedFile file;
+	const unsigned char *bin = nullptr;
+	size_t binSize = 0;
+	std::vector<int> geometry;
+
+	static uint32_t read32(const char *p)
+	{
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	bool readChunks(const char *&json, size_t &jsonSize)
+	{
+		const char *data = file.data();
+		size_t size = file.size();
+		if (size < 12 || read32(data) != MAGIC ||
+		    read32(data + 4) != 2 || read32(data + 8) > size)
+			return false;
+		size = read32(data + 8);
+		for (size_t at = 12; at + 8 <= size;) {
+			size_t length = read32(data + at);
+			uint32_t type = read32(data + at + 4);
+			at += 8;
+			if (length > size - at)
+				return false;
+			if (type == CHUNK_JSON && !json) {
+				json = data + at;
+				jsonSize = length;
+			} else if (type == CHUNK_BIN && !bin) {
+				bin = (const unsigned char *)data + at;
+				binSize = length;
+			}
+			// chunks are padded to 4 bytes
+			at += (length + 3) & ~(size_t)3;
+		}
+		return json != nullptr;
+	}
+
+	bool readViews(const JsonValue &root)
+	{
+		const JsonValue &buffers = root["buffers"];
+		for (size_t i = 0; i < buffers.size(); i++)
+			if (buffers[i].has("uri")) {
+				std::cout << "ERROR::GLB::EXTERNAL_BUFFER: "
+					  << buffers[i]["uri"].string()
+					  << std::endl;
+				return false;
+			}
+		const JsonValue &bufferViews = root["bufferViews"];
+		for (size_t i = 0; i < bufferViews.size(); i++) {
+			const JsonValue &view = bufferViews[i];
+			GlbBufferView v;
+			v.offset = (size_t)view["byteOffset"].number();
+			v.length = (size_t)view["byteLength"].number();
+			v.stride = (size_t)view["byteStride"].number();
+			if (view["buffer"].integer() != 0 ||
+			    v.offset > binSize ||
+			    v.length > binSize - v.offset) {
+				std::cout << "ERROR::GLB::INVALID_BUFFER_VIEW: "
+					  << i << std::endl;
+				return false;
+			}
+			views.push_back(v);
+		}
+		return true;
+	}
+
+	void readImages(const JsonValue &root)
+	{
+		const JsonValue &list = root["images"];
+		for (size_t i = 0; i < list.size(); i++) {
+			GlbImage image;
+			int view = list[i]["bufferView"].integer(-1);
+			if (view >= 0 && view < (int)views.size()) {
+				image.data = viewData(view);
+				image.size = views[view].length;
+			} else if (list[i].has("uri") &&
+				   list[i]["uri"].string().compare(0, 5,
+								   "data:")) {
+				image.uri = list[i]["uri"].string();
+			} else {
+				std::cout << "ERROR::GLB::UNSUPPORTED_IMAGE: "
+					  << i << std::endl;
+			}
+			images.push_back(image);
+		}
+	}
+
+	// the image of a textureInfo, -1 for none
+	int image(const JsonValue &root, const JsonValue &info) const
+	{
+		const JsonValue &texture =
+		    root["textures"][info["index"].integer(-1)];
+		int source = texture["source"].integer(-1);
+		const GlbImage *found =
+		    source >= 0 && source < (int)images.size() ? &images[source]
+							       : nullptr;
+		return found && (found->data || !found->uri.empty()) ? source
+								     : -1;
+	}
+
+	void readMaterials(const JsonValue &root)
+	{
+		const JsonValue &list = root["materials"];
+		for (size_t i = 0; i < list.size(); i++) {
+			const JsonValue &material = list[i];
+			const JsonValue &pbr = material["pbrMetallicRoughness"];
+			const JsonValue &specular =
+			    material["extensions"]["KHR_materials_specular"];
+			GlbMaterial m;
+			m.diffuse = image(root, pbr["baseColorTexture"]);
+			m.specular = image(root, specular["specularTexture"]);
+			m.normal = image(root, material["normalTexture"]);
+			materials.push_back(m);
+		}
+	}
+
+	static glm::mat4 nodeTransform(const JsonValue &node)
+	{
+		glm::mat4 m(1.0f);
+		const JsonValue &matrix = node["matrix"];
+		if (matrix.size() == 16) {
+			for (int c = 0; c < 4; c++)
+				for (int r = 0; r < 4; r++)
+					m[c][r] = (float)matrix[c * 4 + r]
+						      .number();
+			return m;
+		}
+		const JsonValue &t = node["translation"];
+		const JsonValue &q = node["rotation"];
+		const JsonValue &s = node["scale"];
+		if (t.size() == 3)
+			m = glm::translate(m, glm::vec3(t[0].number(),
+							t[1].number(),
+							t[2].number()));
+		if (q.size() == 4) {
+			float x = (float)q[0].number();
+			float y = (float)q[1].number();
+			float z = (float)q[2].number();
+			float w = (float)q[3].number();
+			glm::mat4 r(1.0f);
+			r[0][0] = 1.0f - 2.0f * (y * y + z * z);
+			r[0][1] = 2.0f * (x * y + z * w);
+			r[0][2] = 2.0f * (x * z - y * w);
+			r[1][0] = 2.0f * (x * y - z * w);
+			r[1][1] = 1.0f - 2.0f * (x * x + z * z);
+			r[1][2] = 2.0f * (y * z + x * w);
+			r[2][0] = 2.0f * (x * z + y * w);
+			r[2][1] = 2.0f * (y * z - x * w);
+			r[2][2] = 1.0f - 2.0f * (x * x + y * y);
+			m = m * r;
+		}
+		if (s.size() == 3)
+			m = glm::scale(m, glm::vec3(s[0].number(),
+						    s[1].number(),
+						    s[2].number()));
+		return m;
+	}
+
+	void addNode(const JsonValue &root, int index, glm::mat4 parent,
+		     int depth)
+	{
+		const JsonValue &node = root["nodes"][index];
+		if (index < 0 || !node.isObject() || depth > MAX_DEPTH)
+			return;
+		glm::mat4 transform = parent * nodeTransform(node);
+		int mesh = node["mesh"].integer(-1);
+		if (mesh >= 0) {
+			const JsonValue &list =
+			    root["meshes"][mesh]["primitives"];
+			for (size_t i = 0; i < list.size(); i++)
+				addPrimitive(root, list[i], transform);
+		}
+		const JsonValue &children = node["children"];
+		for (size_t i = 0; i < children.size(); i++)
+			addNode(root, children[i].integer(-1), transform,
+				depth + 1);
+	}
+
+	static int componentSize(GLenum type)
+	{
+		switch (type) {
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+			return 1;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+			return 2;
+		case GL_UNSIGNED_INT:
+		case GL_FLOAT:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	static int componentCount(const std::string &type)
+	{
+		if (type == "SCALAR")
+			return 1;
+		if (type == "VEC2")
+			return 2;
+		if (type == "VEC3")
+			return 3;
+		if (type == "VEC4")
+			return 4;
+		return 0;
+	}
+
+	// checks that an accessor lies within its view; stride is the
+	// distance between its elements
+	bool accessor(const JsonValue &root, int index, GLenum &type,
+		      int &components, int &view, size_t &offset,
+		      size_t &stride, unsigned int &count) const
+	{
+		const JsonValue &a = root["accessors"][index];
+		type = a["componentType"].integer();
+		components = componentCount(a["type"].string());
+		view = a["bufferView"].integer(-1);
+		offset = (size_t)a["byteOffset"].number();
+		count = (unsigned int)a["count"].number();
+		size_t size = componentSize(type) * components;
+		if (a.has("sparse") || size == 0 || view < 0 ||
+		    view >= (int)views.size() || count == 0)
+			return false;
+		const GlbBufferView &v = views[view];
+		stride = v.stride ? v.stride : size;
+		return offset <= v.length && stride >= size &&
+		       (count - 1) * stride + size <= v.length - offset;
+	}
+
+	void addPrimitive(const JsonValue &root, const JsonValue &primitive,
+			  const glm::mat4 &transform)
+	{
+		static const struct {
+			const char *name;
+			GLuint location;
+		} ATTRIBUTES[] = {{"POSITION", 0},
+				  {"NORMAL", 1},
+				  {"TEXCOORD_0", 2},
+				  {"TANGENT", 3}};
+		// 4 (triangles) is the default mode
+		if (primitive["mode"].integer(4) != 4) {
+			std::cout << "ERROR::GLB::UNSUPPORTED_PRIMITIVE_MODE: "
+				  << primitive["mode"].integer() << std::endl;
+			return;
+		}
+		GlbPrimitive p;
+		p.transform = transform;
+		p.material = primitive["material"].integer(-1);
+		if (p.material >= (int)materials.size())
+			p.material = -1;
+		const JsonValue &attributes = primitive["attributes"];
+		for (const auto &attribute : ATTRIBUTES) {
+			if (!attributes.has(attribute.name))
+				continue;
+			int index = attributes[attribute.name].integer(-1);
+			GlbAttribute a;
+			int components;
+			size_t stride;
+			unsigned int count;
+			if (!accessor(root, index, a.type, components, a.view,
+				      a.offset, stride, count) ||
+			    a.type == GL_UNSIGNED_INT ||
+			    (p.vertexCount && count != p.vertexCount)) {
+				std::cout << "ERROR::GLB::INVALID_ACCESSOR: "
+					  << attribute.name << std::endl;
+				return;
+			}
+			a.location = attribute.location;
+			a.size = components;
+			a.normalized =
+			    root["accessors"][index]["normalized"].boolean();
+			a.stride = (GLsizei)stride;
+			p.vertexCount = count;
+			if (a.location == 0)
+				positionBounds(root["accessors"][index], a, p);
+			p.attributes.push_back(a);
+			useView(a.view);
+		}
+		if (p.attributes.empty() || p.attributes[0].location != 0) {
+			std::cout << "ERROR::GLB::MISSING_POSITIONS"
+				  << std::endl;
+			return;
+		}
+		p.count = p.vertexCount;
+		if (primitive.has("indices")) {
+			int components;
+			size_t stride;
+			if (!accessor(root, primitive["indices"].integer(),
+				      p.indexType, components, p.indexView,
+				      p.indexOffset, stride, p.count) ||
+			    components != 1 || p.indexType == GL_BYTE ||
+			    p.indexType == GL_SHORT ||
+			    p.indexType == GL_FLOAT ||
+			    stride != (size_t)componentSize(p.indexType)) {
+				std::cout << "ERROR::GLB::INVALID_INDICES"
+					  << std::endl;
+				return;
+			}
+			useView(p.indexView);
+		}
+		primitives.push_back(p);
+	}
+
+	// min and max are required for POSITION; normalized integers are
+	// scaled the way glVertexAttribPointer does
+	static void positionBounds(const JsonValue &accessor,
+				   const GlbAttribute &a, GlbPrimitive &p)
+	{
+		float scale = 1.0f;
+		if (a.normalized)
+			switch (a.type) {
+			case GL_BYTE:
+				scale = 1.0f / 127.0f;
+				break;
+			case GL_UNSIGNED_BYTE:
+				scale = 1.0f / 255.0f;
+				break;
+			case GL_SHORT:
+				scale = 1.0f / 32767.0f;
+				break;
+			case GL_UNSIGNED_SHORT:
+				scale = 1.0f / 65535.0f;
+				break;
+			}
+		for (int i = 0; i < 3; i++) {
+			p.boundsMin[i] =
+			    (float)accessor["min"][i].number() * scale;
+			p.boundsMax[i] =
+			    (float)accessor["max"][i].number() * scale;
+		}
+	}
+
+	void useView(int view)
+	{
+		auto at = std::lower_bound(geometry.begin(), geometry.end(),
+					   view);
+		if (at == geometry.end() || *at != view)
+			geometry.insert(at, view);
+	}
+};
+#endif
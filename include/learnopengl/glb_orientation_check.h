@@ -0,0 +1,78 @@
+#ifndef GLB_ORIENTATION_CHECK_H
+#define GLB_ORIENTATION_CHECK_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/job_system.h>
+#include <learnopengl/model.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Loads a .glb file through GlbLoader and checks that its first texture
+// reached GL the way glTF lays it out, run by --glb-check once the context
+// exists. The file's image has to be red in its top row and blue in its
+// bottom row (resources/objects/orientation/orientation.glb): glTF puts the
+// top row at v = 0 and the texture coordinates are uploaded as they are,
+// so the first row of the GL texture, at t = 0, must be the red one.
+class GlbOrientationCheck
+{
+      public:
+	bool run(const std::string &path, JobSystem &jobs)
+	{
+		bool native = Model::nativeGlb();
+		Model::nativeGlb() = true;
+		Model model(path, false, &jobs);
+		Model::nativeGlb() = native;
+		if (model.textures_loaded.empty() ||
+		    !model.textures_loaded[0].id) {
+			std::cout << "ERROR::GLB_CHECK::NO_TEXTURE: " << path
+				  << std::endl;
+			return false;
+		}
+
+		GLint width = 0, height = 0;
+		glBindTexture(GL_TEXTURE_2D, model.textures_loaded[0].id);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH,
+					 &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT,
+					 &height);
+		if (width < 1 || height < 2) {
+			std::cout << "ERROR::GLB_CHECK::TEXTURE_SIZE: " << width
+				  << "x" << height << std::endl;
+			glBindTexture(GL_TEXTURE_2D, 0);
+			return false;
+		}
+		std::vector<unsigned char> pixels((size_t)width * height * 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			      pixels.data());
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		const unsigned char *first = pixels.data();
+		const unsigned char *last =
+		    pixels.data() + (size_t)width * (height - 1) * 4;
+		bool passed = isRed(first) && isBlue(last);
+		std::cout << "GLB orientation check: "
+			  << (passed ? "passed" : "failed") << ", first row "
+			  << name(first) << ", last row " << name(last)
+			  << std::endl;
+		return passed;
+	}
+
+      private:
+	static bool isRed(const unsigned char *p)
+	{
+		return p[0] > 200 && p[1] < 50 && p[2] < 50;
+	}
+	static bool isBlue(const unsigned char *p)
+	{
+		return p[0] < 50 && p[1] < 50 && p[2] > 200;
+	}
+	static const char *name(const unsigned char *p)
+	{
+		return isRed(p) ? "red" : isBlue(p) ? "blue" : "neither";
+	}
+};
+#endif
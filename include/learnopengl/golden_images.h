@@ -0,0 +1,276 @@
+#ifndef GOLDEN_IMAGES_H
+#define GOLDEN_IMAGES_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_path.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+// Renders the scene from a list of fixed camera poses and compares each
+// frame against a reference image, so changes to the renderer can be
+// checked for visual regressions. The poses are a CameraPath file where
+// every section is one view named after the section, posed at its first
+// key. Images are binary PPM files named <view>.ppm.
+//
+// Pixels are compared by their CIE76 color difference (Euclidean distance
+// in CIELAB), which follows perceived difference far better than RGB
+// distance does: a difference of about 2.3 is just noticeable. A view
+// passes when at most maxFailedFraction of its pixels differ by more than
+// tolerance. For every view the rendered image and a diff image (the
+// reference dimmed to gray, failed pixels in red, noticeable ones below
+// the tolerance in yellow) are written to the output directory.
+//
+// Rasterization differs slightly between drivers, so references are only
+// rendered and compared on one implementation, Mesa's llvmpipe through
+// --headless, which needs no GPU (LIBGL_ALWAYS_SOFTWARE=1 picks it where
+// there is one).
+class GoldenImages
+{
+      public:
+	// CIE76 difference above which a pixel fails
+	float tolerance = 3.0f;
+	// share of failed pixels a view may have
+	float maxFailedFraction = 0.001f;
+
+	// update writes the rendered views as the new references instead of
+	// comparing them
+	bool load(const std::string &viewsFile, const std::string &referenceDir,
+		  const std::string &outputDir, bool update)
+	{
+		this->referenceDir = referenceDir;
+		this->outputDir = outputDir;
+		this->update = update;
+		if (!views.load(viewsFile))
+			return false;
+		mkdir((update ? referenceDir : outputDir).c_str(), 0755);
+		results.clear();
+		return true;
+	}
+
+	// whether the current context is llvmpipe, the references' renderer
+	static bool checkRenderer()
+	{
+		const char *renderer = (const char *)glGetString(GL_RENDERER);
+		if (renderer && std::strstr(renderer, "llvmpipe"))
+			return true;
+		std::cout << "ERROR::GOLDEN::RENDERER: "
+			  << (renderer ? renderer : "unknown")
+			  << " is not llvmpipe, set LIBGL_ALWAYS_SOFTWARE=1"
+			  << std::endl;
+		return false;
+	}
+
+	// one frame per view
+	unsigned int totalFrames() const
+	{
+		return (unsigned int)views.sectionCount();
+	}
+
+	// poses the camera for frame (counted from 0)
+	void apply(unsigned int frame, Camera &camera) const
+	{
+		const CameraKey &key = views.sectionKey(frame);
+		camera.SetPose(key.position, key.yaw, key.pitch);
+	}
+
+	// reads the finished frame back from the bound read framebuffer and
+	// stores or compares it
+	void capture(unsigned int frame, unsigned int width,
+		     unsigned int height)
+	{
+		std::vector<unsigned char> image(width * height * 3);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE,
+			     image.data());
+		// GL rows go bottom up, PPM rows top down
+		for (unsigned int y = 0; y < height / 2; y++)
+			std::swap_ranges(
+			    image.begin() + y * width * 3,
+			    image.begin() + (y + 1) * width * 3,
+			    image.begin() + (height - 1 - y) * width * 3);
+
+		Result result;
+		result.name = views.sectionName(frame);
+		std::string file = result.name + ".ppm";
+		if (update) {
+			result.passed =
+			    writePPM(referenceDir + '/' + file, width, height,
+				     image);
+			results.push_back(result);
+			return;
+		}
+		writePPM(outputDir + '/' + file, width, height, image);
+
+		unsigned int refWidth = 0, refHeight = 0;
+		std::vector<unsigned char> reference;
+		if (!readPPM(referenceDir + '/' + file, refWidth, refHeight,
+			     reference)) {
+			result.error = "no reference image";
+		} else if (refWidth != width || refHeight != height) {
+			result.error = "reference is " +
+				       std::to_string(refWidth) + "x" +
+				       std::to_string(refHeight);
+		} else {
+			std::vector<unsigned char> diff(image.size());
+			compare(reference, image, diff, result);
+			writePPM(outputDir + '/' + result.name + "_diff.ppm",
+				 width, height, diff);
+			result.passed = result.failedPixels <=
+					maxFailedFraction * width * height;
+		}
+		results.push_back(result);
+	}
+
+	// prints a line per view, returns whether all of them passed
+	bool finish() const
+	{
+		bool passed = true;
+		for (const Result &r : results) {
+			passed = passed && r.passed;
+			if (update) {
+				std::cout << (r.passed ? "UPDATED " : "FAILED ")
+					  << r.name << std::endl;
+				continue;
+			}
+			std::cout << (r.passed ? "PASS " : "FAIL ") << r.name;
+			if (!r.error.empty())
+				std::cout << ": " << r.error << std::endl;
+			else
+				std::cout << ": " << r.failedPixels
+					  << " pixels over " << tolerance
+					  << ", max " << r.maxDifference
+					  << ", mean " << r.meanDifference
+					  << std::endl;
+		}
+		std::cout << "Golden images: " << results.size() << " views "
+			  << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
+	}
+
+	static bool writePPM(const std::string &path, unsigned int width,
+			     unsigned int height,
+			     const std::vector<unsigned char> &rgb)
+	{
+		FILE *out = std::fopen(path.c_str(), "wb");
+		if (!out) {
+			std::cout << "ERROR::GOLDEN_IMAGES::CANNOT_WRITE: "
+				  << path << std::endl;
+			return false;
+		}
+		std::fprintf(out, "P6\n%u %u\n255\n", width, height);
+		std::fwrite(rgb.data(), 1, rgb.size(), out);
+		std::fclose(out);
+		return true;
+	}
+
+	// reads the binary 8-bit PPMs writePPM writes
+	static bool readPPM(const std::string &path, unsigned int &width,
+			    unsigned int &height,
+			    std::vector<unsigned char> &rgb)
+	{
+		FILE *in = std::fopen(path.c_str(), "rb");
+		if (!in)
+			return false;
+		unsigned int maxValue = 0;
+		bool ok = std::fscanf(in, "P6 %u %u %u", &width, &height,
+				      &maxValue) == 3 &&
+			  maxValue == 255 && std::fgetc(in) != EOF;
+		if (ok) {
+			rgb.resize(width * height * 3);
+			ok = std::fread(rgb.data(), 1, rgb.size(), in) ==
+			     rgb.size();
+		}
+		std::fclose(in);
+		if (!ok)
+			std::cout << "ERROR::GOLDEN_IMAGES::BAD_PPM: " << path
+				  << std::endl;
+		return ok;
+	}
+
+      private:
+	struct Result {
+		std::string name;
+		bool passed = false;
+		std::string error;
+		size_t failedPixels = 0;
+		float maxDifference = 0.0f;
+		float meanDifference = 0.0f;
+	};
+
+	CameraPath views;
+	std::string referenceDir;
+	std::string outputDir;
+	bool update = false;
+	std::vector<Result> results;
+
+	void compare(const std::vector<unsigned char> &reference,
+		     const std::vector<unsigned char> &image,
+		     std::vector<unsigned char> &diff, Result &result) const
+	{
+		double sum = 0.0;
+		size_t pixels = image.size() / 3;
+		for (size_t i = 0; i < pixels; i++) {
+			const unsigned char *a = &reference[i * 3];
+			const unsigned char *b = &image[i * 3];
+			glm::vec3 labA = lab(a), labB = lab(b);
+			float difference = glm::length(labA - labB);
+			sum += difference;
+			if (difference > result.maxDifference)
+				result.maxDifference = difference;
+
+			unsigned char *d = &diff[i * 3];
+			unsigned char gray = (unsigned char)(labA.x * 1.25f);
+			d[0] = d[1] = d[2] = gray;
+			if (difference > tolerance) {
+				result.failedPixels++;
+				d[0] = 255;
+				d[1] = d[2] = 0;
+			} else if (difference > 1.0f) {
+				d[0] = d[1] = 255;
+				d[2] = 0;
+			}
+		}
+		result.meanDifference = pixels ? (float)(sum / pixels) : 0.0f;
+	}
+
+	// 8-bit sRGB to CIELAB with a D65 white point, L in [0, 100]
+	static glm::vec3 lab(const unsigned char *rgb)
+	{
+		float linear[3];
+		for (int c = 0; c < 3; c++) {
+			float v = rgb[c] / 255.0f;
+			linear[c] = v <= 0.04045f
+					? v / 12.92f
+					: std::pow((v + 0.055f) / 1.055f, 2.4f);
+		}
+		float x = (0.4124f * linear[0] + 0.3576f * linear[1] +
+			   0.1805f * linear[2]) /
+			  0.95047f;
+		float y = 0.2126f * linear[0] + 0.7152f * linear[1] +
+			  0.0722f * linear[2];
+		float z = (0.0193f * linear[0] + 0.1192f * linear[1] +
+			   0.9505f * linear[2]) /
+			  1.08883f;
+		float fx = labCurve(x), fy = labCurve(y), fz = labCurve(z);
+		return glm::vec3(116.0f * fy - 16.0f, 500.0f * (fx - fy),
+				 200.0f * (fy - fz));
+	}
+
+	static float labCurve(float t)
+	{
+		const float delta = 6.0f / 29.0f;
+		return t > delta * delta * delta
+			   ? std::cbrt(t)
+			   : t / (3.0f * delta * delta) + 4.0f / 29.0f;
+	}
+};
+#endif
@@ -0,0 +1,165 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Measures the GPU time of named passes with GL_TIME_ELAPSED queries. Every
+// pass owns one query per frame in flight; results are read back when that
+// query is about to be reused two frames later, and only if the driver
+// reports them available, so reading never waits for the GPU (a late result
+// is dropped instead). Elapsed-time queries can't overlap, so every begin()
+// is ended before the next pass begins.
+class GpuProfiler
+{
+      public:
+	// frames a query may stay in flight before its result is collected
+	static const int FRAMES_IN_FLIGHT = 2;
+	// samples kept per pass for the rolling statistics
+	static const int HISTORY = 240;
+
+	struct Stats {
+		float average;
+		float p50;
+		float p95;
+		float p99;
+		float last;
+	};
+
+	bool enabled = true;
+
+	GpuProfiler() = default;
+	GpuProfiler(const GpuProfiler &) = delete;
+	GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+	// call once per frame before the first pass, collects the results of
+	// the frame that used the same queries
+	void beginFrame()
+	{
+		frame = (frame + 1) % FRAMES_IN_FLIGHT;
+		for (Pass &pass : passes) {
+			if (!pass.issued[frame])
+				continue;
+			pass.issued[frame] = false;
+			GLint available = 0;
+			glGetQueryObjectiv(pass.queries[frame],
+					   GL_QUERY_RESULT_AVAILABLE,
+					   &available);
+			if (!available) {
+				dropped++;
+				continue;
+			}
+			GLuint64 ns = 0;
+			glGetQueryObjectui64v(pass.queries[frame],
+					      GL_QUERY_RESULT, &ns);
+			pass.history[pass.next] = ns / 1.0e6f;
+			pass.next = (pass.next + 1) % HISTORY;
+			if (pass.count < HISTORY)
+				pass.count++;
+		}
+	}
+
+	// name must stay valid for the lifetime of the profiler (a literal)
+	void begin(const char *name)
+	{
+		if (!enabled)
+			return;
+		if (active != -1) {
+			std::cout << "ERROR::GPU_PROFILER::NESTED_SCOPE: "
+				  << name << std::endl;
+			return;
+		}
+		active = find(name);
+		Pass &pass = passes[active];
+		glBeginQuery(GL_TIME_ELAPSED, pass.queries[frame]);
+		pass.issued[frame] = true;
+	}
+
+	void end()
+	{
+		if (active == -1)
+			return;
+		glEndQuery(GL_TIME_ELAPSED);
+		active = -1;
+	}
+
+	size_t passCount() const { return passes.size(); }
+	const char *passName(size_t pass) const { return passes[pass].name; }
+	// results that were still pending when their query was reused
+	unsigned long droppedCount() const { return dropped; }
+
+	// statistics over the collected samples of a pass in milliseconds
+	Stats stats(size_t index)
+	{
+		const Pass &pass = passes[index];
+		Stats s = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+		if (pass.count == 0)
+			return s;
+		// sized for a full history once, so the copy never reallocates
+		// while the history fills up
+		sorted.reserve(HISTORY);
+		sorted.assign(pass.history, pass.history + pass.count);
+		std::sort(sorted.begin(), sorted.end());
+		for (float ms : sorted)
+			s.average += ms;
+		s.average /= pass.count;
+		s.p50 = percentile(0.50f);
+		s.p95 = percentile(0.95f);
+		s.p99 = percentile(0.99f);
+		s.last = pass.history[(pass.next + HISTORY - 1) % HISTORY];
+		return s;
+	}
+
+	// deletes all queries, must be called while the context is current
+	void clear()
+	{
+		for (Pass &pass : passes)
+			glDeleteQueries(FRAMES_IN_FLIGHT, pass.queries);
+		passes.clear();
+		active = -1;
+	}
+
+      private:
+	struct Pass {
+		const char *name;
+		GLuint queries[FRAMES_IN_FLIGHT];
+		bool issued[FRAMES_IN_FLIGHT];
+		float history[HISTORY];
+		int next;
+		int count;
+	};
+
+	std::vector<Pass> passes;
+	std::vector<float> sorted;
+	int frame = 0;
+	int active = -1;
+	unsigned long dropped = 0;
+
+	int find(const char *name)
+	{
+		for (size_t i = 0; i < passes.size(); i++)
+			if (passes[i].name == name ||
+			    std::strcmp(passes[i].name, name) == 0)
+				return (int)i;
+		Pass pass = {};
+		pass.name = name;
+		glGenQueries(FRAMES_IN_FLIGHT, pass.queries);
+		passes.push_back(pass);
+		return (int)passes.size() - 1;
+	}
+
+	// nearest-rank percentile of the sorted samples
+	float percentile(float p) const
+	{
+		size_t rank = (size_t)(p * sorted.size());
+		if (rank >= sorted.size())
+			rank = sorted.size() - 1;
+		return sorted[rank];
+	}
+};
+#endif
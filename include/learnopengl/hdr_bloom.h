@@ -0,0 +1,248 @@
+#ifndef HDR_BLOOM_H
+#define HDR_BLOOM_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/sampler.h>
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <iostream>
+
+// resolution of the first bloom mip, relative to the scene
+enum BloomResolution {
+	BLOOM_OFF,
+	BLOOM_HALF,
+	BLOOM_FULL,
+	BLOOM_RESOLUTION_COUNT
+};
+
+const char *const BLOOM_RESOLUTION_NAMES[BLOOM_RESOLUTION_COUNT] = {
+    "Off", "Half resolution", "Full resolution"};
+
+// A floating-point scene target and the bloom of it, for tonemapping into
+// the screen:
+//
+// 1. the scene is drawn into framebuffer(), where lights can go past 1
+// 2. bloom_downsample.fs filters it down a chain of mips, each half the
+//    size of the one before, starting at half or full resolution
+// 3. bloom_upsample.fs goes back up the chain, adding every mip's upsampled
+//    blur to the one above it, so the first mip ends up with a wide blur
+//    from a few cheap passes instead of a large Gaussian
+// 4. tonemap.fs mixes the scene with the first mip and maps it to [0, 1]
+//
+//     hdr.configure(width, height, resolution);
+//     bind hdr.framebuffer(), draw the scene
+//     for (int i = 0; i < hdr.mipCount(); i++) {
+//             hdr.beginDownsample(downsampleShader, i, samplers);
+//             draw a quad
+//     }
+//     for (int i = hdr.mipCount() - 1; i > 0; i--) {
+//             hdr.beginUpsample(upsampleShader, i, samplers);
+//             draw a quad
+//     }
+//     hdr.endUpsample();
+//     bind the screen, hdr.beginTonemap(tonemapShader, ...), draw a quad
+class HdrBloom
+{
+      public:
+	static const int MAX_MIPS = 6;
+
+	HdrBloom() = default;
+	HdrBloom(const HdrBloom &) = delete;
+	HdrBloom &operator=(const HdrBloom &) = delete;
+
+	// (re)creates the scene target for a viewport size and the bloom
+	// mips for it, nothing happens while both stay the same
+	void configure(int width, int height, BloomResolution resolution)
+	{
+		if (width != sceneWidth || height != sceneHeight) {
+			clearScene();
+			createScene(width, height);
+		}
+		int divisor = resolution == BLOOM_HALF ? 2 : 1;
+		int w = 0, h = 0;
+		if (resolution != BLOOM_OFF) {
+			w = std::max(1, width / divisor);
+			h = std::max(1, height / divisor);
+		}
+		bloomResolution = resolution;
+		if (w == mipWidths[0] && h == mipHeights[0])
+			return;
+		clearMips();
+		if (resolution != BLOOM_OFF)
+			createMips(w, h);
+	}
+
+	// deletes the targets, must be called while the context is current
+	void clear()
+	{
+		clearScene();
+		clearMips();
+	}
+
+	// the scene target, with a depth buffer in the g-buffer's format so
+	// its depth can be blitted in
+	unsigned int framebuffer() const { return sceneFBO; }
+	bool bloomEnabled() const { return mips > 0; }
+	BloomResolution resolution() const { return bloomResolution; }
+	int mipCount() const { return mips; }
+	int mipWidth(int mip) const { return mipWidths[mip]; }
+	int mipHeight(int mip) const { return mipHeights[mip]; }
+
+	// binds a mip to filter the one above it into, the scene for the
+	// first; the first downsample averages by brightness so single
+	// bright pixels don't flicker in the bloom
+	void beginDownsample(Shader &shader, int mip, SamplerCache &samplers)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, mipFBOs[mip]);
+		glViewport(0, 0, mipWidths[mip], mipHeights[mip]);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D,
+			      mip == 0 ? sceneColor : mipTextures[mip - 1]);
+		glBindSampler(0,
+			      samplers.get(SAMPLER_LINEAR, GL_CLAMP_TO_EDGE));
+		int w = mip == 0 ? sceneWidth : mipWidths[mip - 1];
+		int h = mip == 0 ? sceneHeight : mipHeights[mip - 1];
+		shader.use();
+		shader.setVec2("texelSize", glm::vec2(1.0f / w, 1.0f / h));
+		shader.setInt("firstMip", mip == 0);
+	}
+
+	// binds the mip above one to add its upsampled blur to
+	void beginUpsample(Shader &shader, int mip, SamplerCache &samplers)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, mipFBOs[mip - 1]);
+		glViewport(0, 0, mipWidths[mip - 1], mipHeights[mip - 1]);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, mipTextures[mip]);
+		glBindSampler(0,
+			      samplers.get(SAMPLER_LINEAR, GL_CLAMP_TO_EDGE));
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		shader.use();
+		shader.setFloat("filterRadius", FILTER_RADIUS);
+	}
+	void endUpsample() { glDisable(GL_BLEND); }
+
+	// binds the scene to unit 0 and the bloom to unit 1 of tonemap.fs,
+	// the caller binds the screen and sets its viewport
+	void beginTonemap(Shader &shader, float exposure, float bloomStrength,
+			  SamplerCache &samplers)
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, sceneColor);
+		glBindSampler(0,
+			      samplers.get(SAMPLER_NEAREST, GL_CLAMP_TO_EDGE));
+		if (mips > 0) {
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, mipTextures[0]);
+			glBindSampler(1, samplers.get(SAMPLER_LINEAR,
+						      GL_CLAMP_TO_EDGE));
+			glActiveTexture(GL_TEXTURE0);
+		}
+		shader.use();
+		shader.setFloat("exposure", exposure);
+		shader.setFloat("bloomStrength", bloomStrength);
+	}
+
+      private:
+	// upsampling tent size, in texture coordinates of the mip read
+	static constexpr float FILTER_RADIUS = 0.005f;
+	// the chain stops before a mip's smaller side would go below it
+	static const int MIN_MIP_SIZE = 8;
+
+	int sceneWidth = 0;
+	int sceneHeight = 0;
+	unsigned int sceneFBO = 0;
+	unsigned int sceneColor = 0;
+	unsigned int sceneDepth = 0;
+
+	BloomResolution bloomResolution = BLOOM_OFF;
+	int mips = 0;
+	int mipWidths[MAX_MIPS] = {};
+	int mipHeights[MAX_MIPS] = {};
+	unsigned int mipTextures[MAX_MIPS] = {};
+	unsigned int mipFBOs[MAX_MIPS] = {};
+
+	void createScene(int width, int height)
+	{
+		sceneWidth = width;
+		sceneHeight = height;
+		glGenFramebuffers(1, &sceneFBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+		glGenTextures(1, &sceneColor);
+		glBindTexture(GL_TEXTURE_2D, sceneColor);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0,
+			     GL_RGBA, GL_FLOAT, nullptr);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+				       GL_TEXTURE_2D, sceneColor, 0);
+		glGenRenderbuffers(1, &sceneDepth);
+		glBindRenderbuffer(GL_RENDERBUFFER, sceneDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT,
+				      width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+					  GL_RENDERBUFFER, sceneDepth);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+		    GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::HDR_BLOOM::FRAMEBUFFER: scene not "
+				     "complete"
+				  << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void createMips(int width, int height)
+	{
+		glGenTextures(MAX_MIPS, mipTextures);
+		glGenFramebuffers(MAX_MIPS, mipFBOs);
+		for (mips = 0; mips < MAX_MIPS; mips++) {
+			if (mips > 0 && std::min(width, height) < MIN_MIP_SIZE)
+				break;
+			mipWidths[mips] = width;
+			mipHeights[mips] = height;
+			glBindTexture(GL_TEXTURE_2D, mipTextures[mips]);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, width,
+				     height, 0, GL_RGB, GL_FLOAT, nullptr);
+			glBindFramebuffer(GL_FRAMEBUFFER, mipFBOs[mips]);
+			glFramebufferTexture2D(GL_FRAMEBUFFER,
+					       GL_COLOR_ATTACHMENT0,
+					       GL_TEXTURE_2D,
+					       mipTextures[mips], 0);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+			    GL_FRAMEBUFFER_COMPLETE)
+				std::cout
+				    << "ERROR::HDR_BLOOM::FRAMEBUFFER: mip "
+				    << mips << " not complete" << std::endl;
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void clearScene()
+	{
+		if (sceneWidth == 0)
+			return;
+		glDeleteFramebuffers(1, &sceneFBO);
+		glDeleteTextures(1, &sceneColor);
+		glDeleteRenderbuffers(1, &sceneDepth);
+		sceneFBO = sceneColor = sceneDepth = 0;
+		sceneWidth = sceneHeight = 0;
+	}
+
+	void clearMips()
+	{
+		if (mipWidths[0] == 0)
+			return;
+		// every name was generated, even past the mips in use
+		glDeleteFramebuffers(MAX_MIPS, mipFBOs);
+		glDeleteTextures(MAX_MIPS, mipTextures);
+		mips = 0;
+		for (int i = 0; i < MAX_MIPS; i++)
+			mipWidths[i] = mipHeights[i] = 0;
+	}
+};
+#endif
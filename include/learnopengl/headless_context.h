@@ -0,0 +1,139 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <glad/glad.h>
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <iostream>
+
+// An OpenGL 3.3 core context without a window or display server, made
+// current with no surface at all (EGL_KHR_surfaceless_context), so whatever
+// is drawn has to go to a framebuffer object. On Mesa the surfaceless
+// platform needs neither X11 nor a GPU, the llvmpipe software rasterizer is
+// picked when no hardware driver is available. Without EGL at build time
+// create() always fails.
+class HeadlessContext
+{
+      public:
+	HeadlessContext() = default;
+	HeadlessContext(const HeadlessContext &) = delete;
+	HeadlessContext &operator=(const HeadlessContext &) = delete;
+	~HeadlessContext() { destroy(); }
+
+	bool create()
+	{
+#ifdef HAVE_EGL
+		// prefer the surfaceless platform, the default display may
+		// try to connect to X11 or Wayland
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+			"eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			display = getPlatformDisplay(
+			    EGL_PLATFORM_SURFACELESS_MESA,
+			    (void *)EGL_DEFAULT_DISPLAY, nullptr);
+		if (display == EGL_NO_DISPLAY)
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (display == EGL_NO_DISPLAY ||
+		    !eglInitialize(display, nullptr, nullptr)) {
+			std::cout << "ERROR::HEADLESS::NO_EGL_DISPLAY"
+				  << std::endl;
+			display = EGL_NO_DISPLAY;
+			return false;
+		}
+		if (!eglBindAPI(EGL_OPENGL_API)) {
+			std::cout << "ERROR::HEADLESS::NO_DESKTOP_GL"
+				  << std::endl;
+			return false;
+		}
+
+		// the config only matters for surfaces, without one any config
+		// that supports desktop GL is fine
+		const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE,
+						EGL_OPENGL_BIT, EGL_NONE};
+		EGLConfig config = nullptr;
+		EGLint configCount = 0;
+		eglChooseConfig(display, configAttribs, &config, 1,
+				&configCount);
+
+		const EGLint contextAttribs[] = {
+		    EGL_CONTEXT_MAJOR_VERSION,
+		    3,
+		    EGL_CONTEXT_MINOR_VERSION,
+		    3,
+		    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+		    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		    EGL_NONE};
+		context = eglCreateContext(display,
+					   configCount ? config : nullptr,
+					   EGL_NO_CONTEXT, contextAttribs);
+		if (context == EGL_NO_CONTEXT ||
+		    !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+				    context)) {
+			std::cout
+			    << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED: "
+			    << std::hex << eglGetError() << std::dec
+			    << std::endl;
+			return false;
+		}
+		return true;
+#else
+		std::cout << "ERROR::HEADLESS::BUILT_WITHOUT_EGL" << std::endl;
+		return false;
+#endif
+	}
+
+	// loader for gladLoadGLLoader and ProgramCache::init
+	static GLADloadproc loader()
+	{
+#ifdef HAVE_EGL
+		return (GLADloadproc)eglGetProcAddress;
+#else
+		return nullptr;
+#endif
+	}
+
+	// a context is current on one thread at a time, release it on one
+	// before making it current on another
+	bool makeCurrent()
+	{
+#ifdef HAVE_EGL
+		return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+				      context);
+#else
+		return false;
+#endif
+	}
+	void release()
+	{
+#ifdef HAVE_EGL
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+			       EGL_NO_CONTEXT);
+#endif
+	}
+
+	void destroy()
+	{
+#ifdef HAVE_EGL
+		if (display == EGL_NO_DISPLAY)
+			return;
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+			       EGL_NO_CONTEXT);
+		if (context != EGL_NO_CONTEXT)
+			eglDestroyContext(display, context);
+		eglTerminate(display);
+		display = EGL_NO_DISPLAY;
+		context = EGL_NO_CONTEXT;
+#endif
+	}
+
+      private:
+#ifdef HAVE_EGL
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+#endif
+};
+#endif
@@ -0,0 +1,60 @@
+#ifndef IMGUI_SNAPSHOT_H
+#define IMGUI_SNAPSHOT_H
+
+#include "imgui.h"
+
+#include <memory>
+#include <vector>
+
+// A copy of ImGui's draw data. ImGui::GetDrawData() points into the
+// context and is only valid until the next ImGui::NewFrame; a snapshot owns
+// clones of the draw lists, so one thread can draw a frame's UI while
+// another already builds the next one. Allocating and freeing draw lists
+// touches the ImGui context, so snapshots should be captured and destroyed
+// on the thread that runs ImGui.
+class ImGuiSnapshot
+{
+      public:
+	ImGuiSnapshot() = default;
+	ImGuiSnapshot(const ImGuiSnapshot &) = delete;
+	ImGuiSnapshot &operator=(const ImGuiSnapshot &) = delete;
+	ImGuiSnapshot(ImGuiSnapshot &&other) { *this = std::move(other); }
+	ImGuiSnapshot &operator=(ImGuiSnapshot &&other)
+	{
+		lists = std::move(other.lists);
+		pointers = std::move(other.pointers);
+		data = other.data;
+		data.CmdLists = pointers.data();
+		other.data.Clear();
+		return *this;
+	}
+
+	// copies the draw data of the last ImGui::Render
+	void capture(const ImDrawData *source)
+	{
+		lists.clear();
+		pointers.clear();
+		data.Clear();
+		if (!source || !source->Valid)
+			return;
+		for (int i = 0; i < source->CmdListsCount; i++) {
+			lists.emplace_back(source->CmdLists[i]->CloneOutput());
+			pointers.push_back(lists.back().get());
+		}
+		data = *source;
+		data.CmdLists = pointers.data();
+	}
+
+	// nullptr when nothing was captured
+	ImDrawData *get() { return data.Valid ? &data : nullptr; }
+
+      private:
+	struct Deleter {
+		void operator()(ImDrawList *list) const { IM_DELETE(list); }
+	};
+
+	std::vector<std::unique_ptr<ImDrawList, Deleter>> lists;
+	std::vector<ImDrawList *> pointers;
+	ImDrawData data;
+};
+#endif
@@ -0,0 +1,209 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum InputEventType {
+	INPUT_FRAME = 1, // x = time, y = delta time, starts every frame
+	INPUT_HELD_KEYS, // key = bit mask, written when it changes
+	INPUT_CURSOR,	 // x, y = cursor position
+	INPUT_SCROLL,	 // y = scroll offset
+	INPUT_KEY	 // key, action, mods as glfw passes them
+};
+
+struct InputEvent {
+	int type;
+	float x, y;
+	int key, action, mods;
+};
+
+// Records the input of a session into a compact binary log and plays it
+// back. Every frame starts with an INPUT_FRAME event holding the time since
+// the recording started and the frame's delta time, followed by the
+// frame's held keys if they changed and then the window events polled at
+// its end. A replay hands the same events to the same frames and uses the
+// recorded delta times instead of the clock, so it reproduces the session
+// exactly however fast the replay runs.
+//
+// The log is a magic number followed by the events, each a type byte and
+// a payload of its own size: 8 bytes for frames and cursor positions, 4 for
+// scrolls, 4 for key events and 1 for held keys, in host byte order.
+class InputLog
+{
+      public:
+	~InputLog() { stopRecording(); }
+
+	bool startRecording(const std::string &path)
+	{
+		file = std::fopen(path.c_str(), "wb");
+		if (!file) {
+			std::cout << "ERROR::INPUT_LOG::CANNOT_WRITE: " << path
+				  << std::endl;
+			return false;
+		}
+		std::fwrite(magic(), 1, MAGIC_SIZE, file);
+		recordedKeys = 0;
+		return true;
+	}
+
+	void stopRecording()
+	{
+		if (file)
+			std::fclose(file);
+		file = nullptr;
+	}
+
+	bool recording() const { return file != nullptr; }
+
+	void recordFrame(float time, float deltaTime)
+	{
+		record({INPUT_FRAME, time, deltaTime, 0, 0, 0});
+	}
+	void recordHeldKeys(unsigned int keys)
+	{
+		if (keys != recordedKeys)
+			record({INPUT_HELD_KEYS, 0.0f, 0.0f, (int)keys, 0, 0});
+		recordedKeys = keys;
+	}
+	void recordCursor(double x, double y)
+	{
+		record({INPUT_CURSOR, (float)x, (float)y, 0, 0, 0});
+	}
+	void recordScroll(double y)
+	{
+		record({INPUT_SCROLL, 0.0f, (float)y, 0, 0, 0});
+	}
+	void recordKey(int key, int action, int mods)
+	{
+		record({INPUT_KEY, 0.0f, 0.0f, key, action, mods});
+	}
+
+	bool loadReplay(const std::string &path)
+	{
+		events.clear();
+		frames.clear();
+		FILE *in = std::fopen(path.c_str(), "rb");
+		if (!in) {
+			std::cout << "ERROR::INPUT_LOG::FILE_NOT_FOUND: "
+				  << path << std::endl;
+			return false;
+		}
+		char header[MAGIC_SIZE];
+		bool ok =
+		    std::fread(header, 1, MAGIC_SIZE, in) == MAGIC_SIZE &&
+		    !std::memcmp(header, magic(), MAGIC_SIZE);
+		int type;
+		while (ok && (type = std::fgetc(in)) != EOF) {
+			InputEvent e = {type, 0.0f, 0.0f, 0, 0, 0};
+			ok = read(in, e);
+			if (type == INPUT_FRAME)
+				frames.push_back(events.size());
+			else if (frames.empty())
+				ok = false;
+			events.push_back(e);
+		}
+		std::fclose(in);
+		if (!ok) {
+			std::cout << "ERROR::INPUT_LOG::BAD_LOG: " << path
+				  << std::endl;
+			events.clear();
+			frames.clear();
+		}
+		replayKeys = 0;
+		return ok;
+	}
+
+	bool replaying() const { return !frames.empty(); }
+	size_t frameCount() const { return frames.size(); }
+
+	// starts replaying frame (counted from 0) and returns its delta time
+	float beginFrame(size_t frame)
+	{
+		next = frames[frame];
+		float deltaTime = events[next++].y;
+		if (next < events.size() &&
+		    events[next].type == INPUT_HELD_KEYS)
+			replayKeys = events[next++].key;
+		end = frame + 1 < frames.size() ? frames[frame + 1]
+						: events.size();
+		return deltaTime;
+	}
+	// movement keys held in the current frame
+	unsigned int heldKeys() const { return replayKeys; }
+	// the window events of the current frame, one per call
+	bool nextEvent(InputEvent &e)
+	{
+		if (next >= end)
+			return false;
+		e = events[next++];
+		return true;
+	}
+
+      private:
+	static const size_t MAGIC_SIZE = 8;
+	static const char *magic() { return "LOGLINP1"; }
+
+	FILE *file = nullptr;
+	unsigned int recordedKeys = 0;
+
+	std::vector<InputEvent> events;
+	// index of every frame's INPUT_FRAME event
+	std::vector<size_t> frames;
+	size_t next = 0, end = 0;
+	unsigned int replayKeys = 0;
+
+	void record(const InputEvent &e)
+	{
+		if (!file)
+			return;
+		std::fputc(e.type, file);
+		switch (e.type) {
+		case INPUT_FRAME:
+		case INPUT_CURSOR:
+			std::fwrite(&e.x, sizeof(float), 1, file);
+			std::fwrite(&e.y, sizeof(float), 1, file);
+			break;
+		case INPUT_SCROLL:
+			std::fwrite(&e.y, sizeof(float), 1, file);
+			break;
+		case INPUT_HELD_KEYS:
+			std::fputc(e.key, file);
+			break;
+		case INPUT_KEY: {
+			short key = (short)e.key;
+			std::fwrite(&key, sizeof(short), 1, file);
+			std::fputc(e.action, file);
+			std::fputc(e.mods, file);
+			break;
+		}
+		}
+	}
+
+	static bool read(FILE *in, InputEvent &e)
+	{
+		switch (e.type) {
+		case INPUT_FRAME:
+		case INPUT_CURSOR:
+			return std::fread(&e.x, sizeof(float), 1, in) == 1 &&
+			       std::fread(&e.y, sizeof(float), 1, in) == 1;
+		case INPUT_SCROLL:
+			return std::fread(&e.y, sizeof(float), 1, in) == 1;
+		case INPUT_HELD_KEYS:
+			return (e.key = std::fgetc(in)) != EOF;
+		case INPUT_KEY: {
+			short key;
+			if (std::fread(&key, sizeof(short), 1, in) != 1)
+				return false;
+			e.key = key;
+			return (e.action = std::fgetc(in)) != EOF &&
+			       (e.mods = std::fgetc(in)) != EOF;
+		}
+		}
+		return false;
+	}
+};
+#endif
@@ -0,0 +1,137 @@
+#ifndef JOB_BENCHMARK_H
+#define JOB_BENCHMARK_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/benchmark_runs.h>
+#include <learnopengl/job_system.h>
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Microbenchmarks of the JobSystem, run by --job-benchmark. Every case runs
+// with 1, 2, 4, ... threads (the calling thread plus workers) up to the core
+// count or --job-threads and reports the median of several repetitions:
+//
+// - empty jobs: scheduling overhead per job, spawned from one thread
+// - dependency chain: each job starts when the previous one is done, the
+//   cost of handing a job from one counter to the next
+// - nested spawn: jobs that spawn jobs, most of them run after a steal
+// - matrix updates: a parallelFor over model matrices, the speedup over
+//   one thread shows how the scheduler scales with real work
+class JobBenchmark
+{
+      public:
+	static const int REPETITIONS = 7;
+
+	// maxThreads = 0 goes up to the core count
+	void run(unsigned int maxThreads = 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		std::vector<unsigned int> threadCounts =
+		    BenchmarkRuns::threadCounts(maxThreads);
+		std::printf("Job system benchmark, %u cores, median of %d "
+			    "runs\n",
+			    cores, REPETITIONS);
+		std::printf("%-18s %8s %12s %12s %9s\n", "case", "threads",
+			    "total ms", "ns/job", "speedup");
+		const Case cases[] = {
+		    {"empty jobs", EMPTY_JOBS, &JobBenchmark::emptyJobs},
+		    {"dependency chain", CHAIN_JOBS,
+		     &JobBenchmark::dependencyChain},
+		    {"nested spawn", NESTED_JOBS * NESTED_JOBS,
+		     &JobBenchmark::nestedSpawn},
+		    {"matrix updates", MATRICES / MATRIX_GRAIN,
+		     &JobBenchmark::matrixUpdates}};
+		for (const Case &c : cases) {
+			double single = 0.0;
+			for (unsigned int threads : threadCounts) {
+				JobSystem jobs((int)threads - 1);
+				double ms;
+				BenchmarkRuns::median(
+				    REPETITIONS,
+				    [this, &jobs, &c]() {
+					    (this->*c.function)(jobs);
+					    return true;
+				    },
+				    ms);
+				if (threads == 1)
+					single = ms;
+				std::printf("%-18s %8u %12.3f %12.1f %8.2fx\n",
+					    c.name, threads, ms,
+					    ms * 1.0e6 / c.jobs,
+					    ms > 0.0 ? single / ms : 0.0);
+			}
+		}
+	}
+
+      private:
+	static const int EMPTY_JOBS = 100000;
+	static const int CHAIN_JOBS = 10000;
+	static const int NESTED_JOBS = 256;
+	static const int MATRICES = 1 << 18;
+	static const int MATRIX_GRAIN = 1024;
+
+	struct Case {
+		const char *name;
+		int jobs;
+		void (JobBenchmark::*function)(JobSystem &);
+	};
+
+	std::vector<glm::mat4> locals, worlds;
+
+	void emptyJobs(JobSystem &jobs)
+	{
+		JobCounter counter;
+		for (int i = 0; i < EMPTY_JOBS; i++)
+			jobs.run([]() {}, &counter);
+		jobs.wait(counter);
+	}
+
+	void dependencyChain(JobSystem &jobs)
+	{
+		std::unique_ptr<JobCounter[]> counters(
+		    new JobCounter[CHAIN_JOBS]);
+		jobs.run([]() {}, &counters[0]);
+		for (int i = 1; i < CHAIN_JOBS; i++)
+			jobs.run([]() {}, &counters[i], &counters[i - 1]);
+		jobs.wait(counters[CHAIN_JOBS - 1]);
+	}
+
+	void nestedSpawn(JobSystem &jobs)
+	{
+		JobCounter counter;
+		for (int i = 0; i < NESTED_JOBS; i++)
+			jobs.run(
+			    [&jobs, &counter]() {
+				    for (int j = 0; j < NESTED_JOBS; j++)
+					    jobs.run([]() {}, &counter);
+			    },
+			    &counter);
+		jobs.wait(counter);
+	}
+
+	// world = parent * local for every matrix, like a transform update
+	void matrixUpdates(JobSystem &jobs)
+	{
+		if (locals.empty()) {
+			locals.resize(MATRICES);
+			worlds.resize(MATRICES);
+			for (int i = 0; i < MATRICES; i++)
+				locals[i] = glm::mat4(1.0f + i % 7);
+		}
+		const glm::mat4 parent(2.0f);
+		JobCounter counter;
+		jobs.parallelFor(
+		    MATRICES, MATRIX_GRAIN,
+		    [this, &parent](size_t begin, size_t end) {
+			    for (size_t i = begin; i < end; i++)
+				    worlds[i] = parent * locals[i];
+		    },
+		    &counter);
+		jobs.wait(counter);
+	}
+};
+#endif
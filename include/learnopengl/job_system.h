@@ -0,0 +1,275 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <learnopengl/cpu_profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class JobCounter;
+
+struct Job {
+	std::function<void()> function;
+	// decremented once the job is done, may be nullptr
+	JobCounter *counter;
+};
+
+// Counts the unfinished jobs of a group: JobSystem::run increments it and
+// every job decrements it when done. Jobs can be made to start once a
+// counter drops to zero, and JobSystem::wait blocks on one. A counter must
+// outlive the jobs counted by it and those waiting for it.
+class JobCounter
+{
+      public:
+	JobCounter() = default;
+	JobCounter(const JobCounter &) = delete;
+	JobCounter &operator=(const JobCounter &) = delete;
+
+	bool done() const { return pending.load() == 0; }
+
+      private:
+	friend class JobSystem;
+
+	std::atomic<int> pending{0};
+	std::mutex mutex;
+	// jobs that start when pending drops to zero
+	std::vector<Job> waiting;
+};
+
+// A work-stealing job scheduler. Every worker thread has a deque of its own:
+// it pushes and pops jobs at the back, so it keeps working on what it just
+// spawned while that's still in cache, and when its deque runs dry it
+// steals from the front of the others, taking the oldest (usually biggest)
+// jobs. Threads that aren't workers (the main thread, the render thread)
+// share one extra deque and help run jobs while they wait for a counter,
+// so waiting never blocks a core that could be working.
+//
+// The deques are guarded by a mutex each rather than lock-free; jobs are
+// meant to be coarse enough (tens of microseconds and up) that this doesn't
+// matter, the job benchmark (--job-benchmark) shows the overhead.
+class JobSystem
+{
+      public:
+	// by default one worker per core besides the calling thread; with no
+	// workers jobs only run inside wait()
+	explicit JobSystem(int workers = -1)
+	{
+		if (workers < 0) {
+			int cores = (int)std::thread::hardware_concurrency();
+			workers = cores > 1 ? cores - 1 : 1;
+		}
+		// deque 0 is shared by all threads that aren't workers
+		for (int i = 0; i <= workers; i++)
+			queues.emplace_back(new Queue());
+		for (int i = 1; i <= workers; i++)
+			threads.emplace_back([this, i]() { work(i); });
+	}
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+	// runs the jobs still queued, jobs waiting for a counter that never
+	// drops to zero are dropped
+	~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread &thread : threads)
+			thread.join();
+	}
+
+	unsigned int workerCount() const
+	{
+		return (unsigned int)threads.size();
+	}
+
+	// queues function, counted by counter if given; with after it only
+	// starts once after is done
+	void run(std::function<void()> function, JobCounter *counter = nullptr,
+		 JobCounter *after = nullptr)
+	{
+		if (counter)
+			counter->pending++;
+		Job job = {std::move(function), counter};
+		if (after) {
+			std::lock_guard<std::mutex> lock(after->mutex);
+			if (!after->done()) {
+				after->waiting.push_back(std::move(job));
+				return;
+			}
+		}
+		push(std::move(job));
+	}
+
+	// splits [0, count) into jobs of up to grain items and calls
+	// function(begin, end) for each
+	void parallelFor(size_t count, size_t grain,
+			 std::function<void(size_t, size_t)> function,
+			 JobCounter *counter, JobCounter *after = nullptr)
+	{
+		if (grain == 0)
+			grain = 1;
+		for (size_t begin = 0; begin < count; begin += grain) {
+			size_t end = std::min(begin + grain, count);
+			run([function, begin, end]() { function(begin, end); },
+			    counter, after);
+		}
+	}
+
+	// runs queued jobs until counter is done, afterwards the counter may
+	// be destroyed
+	void wait(JobCounter &counter)
+	{
+		CPU_ZONE("JobSystem::wait");
+		while (!counter.done()) {
+			Job job;
+			if (pop(job))
+				execute(job);
+			else
+				std::this_thread::yield();
+		}
+		// the last job may still be releasing the counter's mutex
+		std::lock_guard<std::mutex> lock(counter.mutex);
+	}
+
+	// jobs taken from another thread's deque so far
+	unsigned long long stealCount() const { return steals.load(); }
+
+      private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> threads;
+	// jobs in the deques, workers sleep while it's zero
+	std::atomic<int> queued{0};
+	std::atomic<int> sleeping{0};
+	std::atomic<unsigned long long> steals{0};
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	bool stopping = false;
+
+	struct ThreadSlot {
+		const JobSystem *system;
+		unsigned int index;
+	};
+	static ThreadSlot &threadSlot()
+	{
+		static thread_local ThreadSlot slot = {nullptr, 0};
+		return slot;
+	}
+	// the deque of the calling thread
+	unsigned int queueIndex() const
+	{
+		const ThreadSlot &slot = threadSlot();
+		return slot.system == this ? slot.index : 0;
+	}
+
+	void push(Job &&job)
+	{
+		Queue &queue = *queues[queueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(job));
+		}
+		queued++;
+		// a worker that's about to sleep sees queued first
+		if (sleeping.load() > 0) {
+			{
+				std::lock_guard<std::mutex> lock(sleepMutex);
+			}
+			wake.notify_one();
+		}
+	}
+
+	bool pop(Job &job)
+	{
+		if (queued.load() == 0)
+			return false;
+		unsigned int own = queueIndex();
+		{
+			Queue &queue = *queues[own];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty()) {
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				queued--;
+				return true;
+			}
+		}
+		for (size_t i = 1; i < queues.size(); i++) {
+			Queue &queue = *queues[(own + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty()) {
+				job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				queued--;
+				steals++;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void execute(Job &job)
+	{
+		job.function();
+		if (job.counter)
+			finish(*job.counter);
+	}
+
+	void finish(JobCounter &counter)
+	{
+		// only the step to zero needs the lock, run() checks for it
+		// while holding it
+		int pending = counter.pending.load();
+		while (pending > 1)
+			if (counter.pending.compare_exchange_weak(pending,
+								  pending - 1))
+				return;
+		std::vector<Job> ready;
+		{
+			std::lock_guard<std::mutex> lock(counter.mutex);
+			if (--counter.pending > 0)
+				return;
+			ready.swap(counter.waiting);
+		}
+		for (Job &job : ready)
+			push(std::move(job));
+	}
+
+	void work(unsigned int index)
+	{
+		threadSlot() = {this, index};
+		CpuProfiler::setThreadName("job worker " +
+					   std::to_string(index));
+		for (;;) {
+			Job job;
+			if (pop(job)) {
+				execute(job);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleeping++;
+			wake.wait(lock, [this]() {
+				return queued.load() > 0 || stopping;
+			});
+			sleeping--;
+			if (stopping && queued.load() == 0)
+				return;
+		}
+	}
+};
+#endif
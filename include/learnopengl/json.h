@@ -0,0 +1,343 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A parsed JSON document, just enough of the format for glTF: numbers are
+// doubles, strings keep their escapes decoded to UTF-8 and objects keep
+// their members in file order. Looking up a missing member or element
+// yields a null value, so lookups can be chained without checks.
+class JsonValue
+{
+      public:
+	enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+	Type type = NUL;
+
+	// parses [begin, end), on failure error holds the reason
+	static bool parse(const char *begin, const char *end, JsonValue &value,
+			  std::string &error)
+	{
+		Parser parser = {begin, end, std::string()};
+		value = JsonValue();
+		if (parser.value(value, 0)) {
+			parser.skip();
+			if (parser.p == end)
+				return true;
+			parser.fail("trailing characters");
+		}
+		error = parser.error;
+		return false;
+	}
+
+	bool isNull() const { return type == NUL; }
+	bool isNumber() const { return type == NUMBER; }
+	bool isString() const { return type == STRING; }
+	bool isArray() const { return type == ARRAY; }
+	bool isObject() const { return type == OBJECT; }
+
+	double number(double fallback = 0.0) const
+	{
+		return type == NUMBER ? numberValue : fallback;
+	}
+	int integer(int fallback = 0) const
+	{
+		return type == NUMBER ? (int)numberValue : fallback;
+	}
+	bool boolean(bool fallback = false) const
+	{
+		return type == BOOLEAN ? numberValue != 0.0 : fallback;
+	}
+	const std::string &string() const { return stringValue; }
+
+	// elements of an array or members of an object
+	size_t size() const
+	{
+		return type == ARRAY ? elements.size() : members.size();
+	}
+	const JsonValue &operator[](size_t i) const
+	{
+		return type == ARRAY && i < elements.size() ? elements[i]
+							    : null();
+	}
+	// negative indices are never there, so glTF's -1 for none works
+	const JsonValue &operator[](int i) const
+	{
+		return i >= 0 ? (*this)[(size_t)i] : null();
+	}
+	const JsonValue &operator[](const char *name) const
+	{
+		for (const auto &member : members)
+			if (member.first == name)
+				return member.second;
+		return null();
+	}
+	bool has(const char *name) const { return !(*this)[name].isNull(); }
+	const std::vector<std::pair<std::string, JsonValue>> &
+	objectMembers() const
+	{
+		return members;
+	}
+
+      private:
+	// nesting deeper than this is rejected instead of overflowing the
+	// stack
+	static const int MAX_DEPTH = 64;
+
+	double numberValue = 0.0;
+	std::string stringValue;
+	std::vector<JsonValue> elements;
+	std::vector<std::pair<std::string, JsonValue>> members;
+
+	static const JsonValue &null()
+	{
+		static const JsonValue value;
+		return value;
+	}
+
+	struct Parser {
+		const char *p;
+		const char *end;
+		std::string error;
+
+		void skip()
+		{
+			while (p < end && (*p == ' ' || *p == '\t' ||
+					   *p == '\n' || *p == '\r'))
+				p++;
+		}
+
+		bool fail(const char *message)
+		{
+			if (error.empty())
+				error = message;
+			return false;
+		}
+
+		bool literal(const char *word)
+		{
+			size_t length = std::strlen(word);
+			if ((size_t)(end - p) < length ||
+			    std::strncmp(p, word, length) != 0)
+				return fail("invalid literal");
+			p += length;
+			return true;
+		}
+
+		bool value(JsonValue &value, int depth)
+		{
+			if (depth > MAX_DEPTH)
+				return fail("nested too deeply");
+			skip();
+			if (p == end)
+				return fail("unexpected end");
+			switch (*p) {
+			case '{':
+				return object(value, depth);
+			case '[':
+				return array(value, depth);
+			case '"':
+				value.type = STRING;
+				return string(value.stringValue);
+			case 't':
+				value.type = BOOLEAN;
+				value.numberValue = 1.0;
+				return literal("true");
+			case 'f':
+				value.type = BOOLEAN;
+				return literal("false");
+			case 'n':
+				return literal("null");
+			default:
+				return number(value);
+			}
+		}
+
+		bool object(JsonValue &value, int depth)
+		{
+			value.type = OBJECT;
+			p++;
+			skip();
+			if (p < end && *p == '}') {
+				p++;
+				return true;
+			}
+			for (;;) {
+				skip();
+				value.members.emplace_back();
+				auto &member = value.members.back();
+				if (p == end || *p != '"' ||
+				    !string(member.first))
+					return fail("expected a member name");
+				skip();
+				if (p == end || *p++ != ':')
+					return fail("expected ':'");
+				if (!this->value(member.second, depth + 1))
+					return false;
+				skip();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				if (p < end && *p == '}') {
+					p++;
+					return true;
+				}
+				return fail("expected ',' or '}'");
+			}
+		}
+
+		bool array(JsonValue &value, int depth)
+		{
+			value.type = ARRAY;
+			p++;
+			skip();
+			if (p < end && *p == ']') {
+				p++;
+				return true;
+			}
+			for (;;) {
+				value.elements.emplace_back();
+				if (!this->value(value.elements.back(),
+						 depth + 1))
+					return false;
+				skip();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				if (p < end && *p == ']') {
+					p++;
+					return true;
+				}
+				return fail("expected ',' or ']'");
+			}
+		}
+
+		bool number(JsonValue &value)
+		{
+			// strtod needs a terminated string, numbers are short
+			char buffer[64];
+			size_t length = 0;
+			while (p + length < end &&
+			       length < sizeof(buffer) - 1 &&
+			       std::strchr("+-0123456789.eE", p[length]))
+				length++;
+			if (length == 0)
+				return fail("unexpected character");
+			std::memcpy(buffer, p, length);
+			buffer[length] = '\0';
+			char *parsed;
+			value.numberValue = std::strtod(buffer, &parsed);
+			if (parsed != buffer + length)
+				return fail("invalid number");
+			value.type = NUMBER;
+			p += length;
+			return true;
+		}
+
+		static int hex(char c)
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+			if (c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			return -1;
+		}
+
+		bool codePoint(unsigned int &code)
+		{
+			if (end - p < 4)
+				return fail("invalid escape");
+			code = 0;
+			for (int i = 0; i < 4; i++) {
+				int digit = hex(*p++);
+				if (digit < 0)
+					return fail("invalid escape");
+				code = code << 4 | digit;
+			}
+			return true;
+		}
+
+		static void utf8(unsigned int code, std::string &out)
+		{
+			if (code < 0x80) {
+				out += (char)code;
+			} else if (code < 0x800) {
+				out += (char)(0xC0 | code >> 6);
+				out += (char)(0x80 | (code & 0x3F));
+			} else if (code < 0x10000) {
+				out += (char)(0xE0 | code >> 12);
+				out += (char)(0x80 | (code >> 6 & 0x3F));
+				out += (char)(0x80 | (code & 0x3F));
+			} else {
+				out += (char)(0xF0 | code >> 18);
+				out += (char)(0x80 | (code >> 12 & 0x3F));
+				out += (char)(0x80 | (code >> 6 & 0x3F));
+				out += (char)(0x80 | (code & 0x3F));
+			}
+		}
+
+		bool string(std::string &out)
+		{
+			p++;
+			for (;;) {
+				const char *run = p;
+				while (p < end && *p != '"' && *p != '\\')
+					p++;
+				out.append(run, p);
+				if (p == end)
+					return fail("unterminated string");
+				if (*p++ == '"')
+					return true;
+				if (p == end)
+					return fail("unterminated string");
+				char escape = *p++;
+				unsigned int code;
+				switch (escape) {
+				case 'b':
+					out += '\b';
+					break;
+				case 'f':
+					out += '\f';
+					break;
+				case 'n':
+					out += '\n';
+					break;
+				case 'r':
+					out += '\r';
+					break;
+				case 't':
+					out += '\t';
+					break;
+				case 'u':
+					if (!codePoint(code))
+						return false;
+					// a surrogate pair
+					if (code >= 0xD800 && code < 0xDC00 &&
+					    end - p >= 6 && p[0] == '\\' &&
+					    p[1] == 'u') {
+						unsigned int low;
+						p += 2;
+						if (!codePoint(low))
+							return false;
+						code = 0x10000 +
+						       ((code - 0xD800) << 10) +
+						       (low - 0xDC00);
+					}
+					utf8(code, out);
+					break;
+				default:
+					out += escape;
+				}
+			}
+		}
+	};
+};
+#endif
@@ -0,0 +1,72 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A file's bytes, memory-mapped where possible and read otherwise.
+class MappedFile
+{
+      public:
+	MappedFile() = default;
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	~MappedFile() { close(); }
+
+	bool open(const std::string &path)
+	{
+		close();
+#ifdef __linux__
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat st;
+		if (fd != -1 && fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *data = mmap(nullptr, st.st_size, PROT_READ,
+					  MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				madvise(data, st.st_size, MADV_SEQUENTIAL);
+				mapped = (const char *)data;
+				length = st.st_size;
+			}
+		}
+		if (fd != -1)
+			::close(fd);
+		if (mapped)
+			return true;
+#endif
+		std::ifstream in(path, std::ios::binary);
+		if (!in)
+			return false;
+		copy.assign(std::istreambuf_iterator<char>(in),
+			    std::istreambuf_iterator<char>());
+		length = copy.size();
+		return true;
+	}
+
+	void close()
+	{
+#ifdef __linux__
+		if (mapped)
+			munmap((void *)mapped, length);
+#endif
+		mapped = nullptr;
+		copy.clear();
+		length = 0;
+	}
+
+	const char *data() const { return mapped ? mapped : copy.data(); }
+	size_t size() const { return length; }
+
+      private:
+	const char *mapped = nullptr;
+	std::vector<char> copy;
+	size_t length = 0;
+};
+#endif
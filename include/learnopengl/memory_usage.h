@@ -0,0 +1,43 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// The resident memory of the process as Linux reports it in
+// /proc/self/status; everything is 0 on other systems.
+class MemoryUsage
+{
+      public:
+	static size_t residentBytes() { return statusField("VmRSS:"); }
+	// the most resident memory so far, or since resetPeak
+	static size_t peakResidentBytes() { return statusField("VmHWM:"); }
+
+	// makes the current resident size the peak, false where the kernel
+	// doesn't allow it (before Linux 4.0)
+	static bool resetPeak()
+	{
+		std::ofstream clear("/proc/self/clear_refs");
+		clear << "5";
+		clear.flush();
+		return (bool)clear;
+	}
+
+      private:
+	// a "Name:   1234 kB" line
+	static size_t statusField(const char *name)
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		size_t length = std::strlen(name);
+		while (std::getline(status, line))
+			if (line.compare(0, length, name) == 0)
+				return std::strtoull(line.c_str() + length,
+						     nullptr, 10) *
+				       1024;
+		return 0;
+	}
+};
+#endif
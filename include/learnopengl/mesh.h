@@ -8,7 +8,9 @@
 
 #include <learnopengl/shader.h>
 
+#include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 using namespace std;
 
@@ -25,12 +27,46 @@ struct Vertex {
 	glm::vec3 Bitangent;
 };
 
+// a vertex attribute read straight from a buffer the mesh doesn't own, in
+// the terms of glVertexAttribPointer
+struct VertexAttribute {
+	GLuint location;
+	GLint size;
+	GLenum type;
+	GLboolean normalized;
+	GLsizei stride;
+	size_t offset;
+	unsigned int buffer;
+};
+
+enum TextureType {
+	TEXTURE_DIFFUSE,
+	TEXTURE_SPECULAR,
+	TEXTURE_NORMAL,
+	TEXTURE_HEIGHT,
+	TEXTURE_TYPE_COUNT
+};
+
+// the sampler uniforms of a type are its name followed by 1, 2, ...
+const char *const TEXTURE_TYPE_NAMES[TEXTURE_TYPE_COUNT] = {
+    "texture_diffuse", "texture_specular", "texture_normal", "texture_height"};
+
+// Mesh textures go to fixed units: the n-th texture (from 0) of a type to
+// unit n * TEXTURE_TYPE_COUNT + type, so texture_diffuse1 is on unit 0,
+// texture_specular1 on 1, ... and texture_diffuse2 on 4. Textures past
+// MESH_TEXTURES_PER_TYPE of one type aren't bound.
+const int MESH_TEXTURES_PER_TYPE = 2;
+const int MESH_TEXTURE_UNITS = MESH_TEXTURES_PER_TYPE * TEXTURE_TYPE_COUNT;
+
 struct Texture {
 	unsigned int id;
-	string type;
+	TextureType type;
 	string path;
 };
 
+// Owns its vertex array and, unless it draws from buffers owned by someone
+// else, its vertex and index buffers, deleted with the mesh. A mesh can be
+// moved but not copied, so there's always exactly one owner.
 class Mesh
 {
       public:
@@ -39,65 +75,106 @@ class Mesh
 	vector<unsigned int> indices;
 	vector<Texture> textures;
 
-	unsigned int VAO;
-	std::string glslIdentifierPrefix;
-	// constructor
+	unsigned int VAO = 0;
+	// where the mesh sits in its model, applied by Model::Draw with a
+	// model matrix
+	glm::mat4 transform = glm::mat4(1.0f);
+	unsigned int vertexCount = 0;
+	// bounding box of the vertex positions, before transform
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	// constructor, pass the arrays with std::move to avoid copying them
 	Mesh(vector<Vertex> vertices, vector<unsigned int> indices,
 	     vector<Texture> textures)
+	    : vertices(std::move(vertices)), indices(std::move(indices)),
+	      textures(std::move(textures))
 	{
-		this->vertices = vertices;
-		this->indices = indices;
-		this->textures = textures;
-
 		// now that we have all the required data, set the vertex
 		// buffers and its attribute pointers.
 		setupMesh();
+		resolveTextureUnits();
+	}
+
+	// draws from buffers owned by the caller, such as the buffer views of
+	// a glTF file, without keeping vertices and indices; indexBuffer 0
+	// draws count vertices in order, otherwise count indices of
+	// indexType starting at indexOffset
+	Mesh(const vector<VertexAttribute> &attributes,
+	     unsigned int vertexCount, unsigned int indexBuffer,
+	     GLenum indexType, size_t indexOffset, unsigned int count,
+	     vector<Texture> textures)
+	    : textures(std::move(textures)), vertexCount(vertexCount),
+	      EBO(indexBuffer), ownsBuffers(false), drawCount(count),
+	      indexType(indexType), indexOffset(indexOffset)
+	{
+		glGenVertexArrays(1, &VAO);
+		glBindVertexArray(VAO);
+		for (const VertexAttribute &a : attributes) {
+			glBindBuffer(GL_ARRAY_BUFFER, a.buffer);
+			glEnableVertexAttribArray(a.location);
+			glVertexAttribPointer(a.location, a.size, a.type,
+					      a.normalized, a.stride,
+					      (void *)a.offset);
+		}
+		if (EBO)
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBindVertexArray(0);
+		resolveTextureUnits();
+	}
+
+	Mesh(const Mesh &) = delete;
+	Mesh &operator=(const Mesh &) = delete;
+	Mesh(Mesh &&other) noexcept { take(other); }
+	Mesh &operator=(Mesh &&other) noexcept
+	{
+		if (this != &other) {
+			release();
+			take(other);
+		}
+		return *this;
 	}
+	~Mesh() { release(); }
 
-	// render the mesh
+	// frees vertices and indices once they're in the GL buffers, when
+	// nothing needs them on the CPU any more
+	void freeCpuCopy()
+	{
+		vector<Vertex>().swap(vertices);
+		vector<unsigned int>().swap(indices);
+	}
+
+	// points the shader's sampler uniforms (prefix + texture_diffuse1 and
+	// so on) at the units Draw binds textures to; once per shader is
+	// enough, reloads keep the values
+	static void SetSamplerUnits(Shader &shader, const std::string &prefix)
+	{
+		shader.use();
+		for (int n = 0; n < MESH_TEXTURES_PER_TYPE; n++)
+			for (int type = 0; type < TEXTURE_TYPE_COUNT; type++) {
+				std::string name = prefix +
+						   TEXTURE_TYPE_NAMES[type] +
+						   std::to_string(n + 1);
+				shader.setInt(name.c_str(),
+					      n * TEXTURE_TYPE_COUNT + type);
+			}
+	}
+
+	// render the mesh, its textures go to the units resolved at load (see
+	// SetSamplerUnits); nothing here allocates
 	void Draw(Shader &shader)
 	{
-		// bind appropriate textures
-		unsigned int diffuseNr = 1;
-		unsigned int specularNr = 1;
-		unsigned int normalNr = 1;
-		unsigned int heightNr = 1;
-		for (unsigned int i = 0; i < textures.size(); i++) {
-			glActiveTexture(
-			    GL_TEXTURE0 +
-			    i); // active proper texture unit before binding
-			// retrieve texture number (the N in diffuse_textureN)
-			string number;
-			string name = textures[i].type;
-			if (name == "texture_diffuse")
-				number = std::to_string(diffuseNr++);
-			else if (name == "texture_specular")
-				number = std::to_string(
-				    specularNr++); // transfer unsigned int to
-						   // stream
-			else if (name == "texture_normal")
-				number = std::to_string(
-				    normalNr++); // transfer unsigned int to
-						 // stream
-			else if (name == "texture_height")
-				number = std::to_string(
-				    heightNr++); // transfer unsigned int to
-						 // stream
-
-			// now set the sampler to the correct texture unit
-			glUniform1i(
-			    glGetUniformLocation(
-				shader.ID,
-				(glslIdentifierPrefix + name + number).c_str()),
-			    i);
-			// and finally bind the texture
-			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+		for (const TextureBinding &binding : bindings) {
+			glActiveTexture(GL_TEXTURE0 + binding.unit);
+			glBindTexture(GL_TEXTURE_2D, binding.id);
 		}
 
 		// draw mesh
 		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT,
-			       0);
+		if (EBO)
+			glDrawElements(GL_TRIANGLES, drawCount, indexType,
+				       (void *)indexOffset);
+		else
+			glDrawArrays(GL_TRIANGLES, 0, drawCount);
 		glBindVertexArray(0);
 
 		// always good practice to set everything back to defaults once
@@ -107,11 +184,82 @@ class Mesh
 
       private:
 	// render data
-	unsigned int VBO, EBO;
+	unsigned int VBO = 0, EBO = 0;
+	// false when VBO and EBO belong to someone else
+	bool ownsBuffers = true;
+	unsigned int drawCount = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+	size_t indexOffset = 0;
+
+	struct TextureBinding {
+		unsigned int unit;
+		unsigned int id;
+	};
+	vector<TextureBinding> bindings;
+
+	// the unit of every texture by type and order, see TEXTURE_TYPE_NAMES
+	void resolveTextureUnits()
+	{
+		int count[TEXTURE_TYPE_COUNT] = {};
+		bindings.clear();
+		for (const Texture &texture : textures) {
+			int n = count[texture.type]++;
+			if (n >= MESH_TEXTURES_PER_TYPE) {
+				std::cout << "ERROR::MESH::TOO_MANY_TEXTURES: "
+					  << texture.path << std::endl;
+				continue;
+			}
+			bindings.push_back(
+			    {(unsigned int)(n * TEXTURE_TYPE_COUNT +
+					    texture.type),
+			     texture.id});
+		}
+	}
+
+	void take(Mesh &other)
+	{
+		vertices = std::move(other.vertices);
+		indices = std::move(other.indices);
+		textures = std::move(other.textures);
+		bindings = std::move(other.bindings);
+		transform = other.transform;
+		vertexCount = other.vertexCount;
+		boundsMin = other.boundsMin;
+		boundsMax = other.boundsMax;
+		VAO = other.VAO;
+		VBO = other.VBO;
+		EBO = other.EBO;
+		ownsBuffers = other.ownsBuffers;
+		drawCount = other.drawCount;
+		indexType = other.indexType;
+		indexOffset = other.indexOffset;
+		other.VAO = other.VBO = other.EBO = 0;
+	}
+
+	void release()
+	{
+		if (VAO)
+			glDeleteVertexArrays(1, &VAO);
+		if (ownsBuffers) {
+			if (VBO)
+				glDeleteBuffers(1, &VBO);
+			if (EBO)
+				glDeleteBuffers(1, &EBO);
+		}
+		VAO = VBO = EBO = 0;
+	}
 
 	// initializes all the buffer objects/arrays
 	void setupMesh()
 	{
+		vertexCount = (unsigned int)vertices.size();
+		drawCount = (unsigned int)indices.size();
+		if (!vertices.empty())
+			boundsMin = boundsMax = vertices[0].Position;
+		for (const Vertex &vertex : vertices) {
+			boundsMin = glm::min(boundsMin, vertex.Position);
+			boundsMax = glm::max(boundsMax, vertex.Position);
+		}
 		// create buffers/arrays
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
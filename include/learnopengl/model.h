@@ -10,20 +10,51 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <stb_image.h>
 
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/glb_loader.h>
+#include <learnopengl/job_system.h>
 #include <learnopengl/mesh.h>
+#include <learnopengl/obj_loader.h>
 #include <learnopengl/shader.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 using namespace std;
 
 unsigned int TextureFromFile(const char *path, const string &directory,
 			     bool gamma = false);
 
+// the pixels of an image file, decoded on any thread
+struct TextureImage {
+	unsigned char *data = nullptr;
+	int width = 0;
+	int height = 0;
+	int nrComponents = 0;
+};
+
+TextureImage DecodeTextureFile(const char *path, const string &directory);
+
+// decodes an image file that's already in memory
+TextureImage DecodeTextureMemory(const unsigned char *data, size_t size);
+
+// turns a decoded image upside down
+void FlipTextureRows(TextureImage &image);
+
+// creates a GL texture from a decoded image and frees its pixels
+unsigned int UploadTexture(TextureImage &image, const char *path);
+
+// Owns its meshes, the textures in textures_loaded and the buffers of a
+// .glb file, all deleted with the model or by clear(). Like Mesh it can be
+// moved but not copied.
 class Model
 {
       public:
@@ -35,11 +66,57 @@ class Model
 	vector<Mesh> meshes;
 	string directory;
 	bool gammaCorrection;
+	// bytes of vertex and index data in GL buffers
+	size_t bufferBytes = 0;
 
-	// constructor, expects a filepath to a 3D model.
-	Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+	// the post-processing asked of Assimp, ObjBenchmark uses it too;
+	// identical vertices are joined like the native loaders join them
+	static const unsigned int ASSIMP_FLAGS =
+	    aiProcess_Triangulate | aiProcess_JoinIdenticalVertices |
+	    aiProcess_GenSmoothNormals | aiProcess_FlipUVs |
+	    aiProcess_CalcTangentSpace;
+
+	// constructor, expects a filepath to a 3D model. With a job system
+	// the meshes are converted and the textures decoded in parallel.
+	// Without keepCpuCopy the meshes free their vertices and indices once
+	// they're uploaded.
+	Model(string const &path, bool gamma = false,
+	      JobSystem *jobs = nullptr, bool keepCpuCopy = true)
+	    : gammaCorrection(gamma)
 	{
-		loadModel(path);
+		loadModel(path, jobs);
+		if (!keepCpuCopy)
+			for (Mesh &mesh : meshes)
+				mesh.freeCpuCopy();
+	}
+
+	Model(const Model &) = delete;
+	Model &operator=(const Model &) = delete;
+	Model(Model &&other) noexcept { take(other); }
+	Model &operator=(Model &&other) noexcept
+	{
+		if (this != &other) {
+			clear();
+			take(other);
+		}
+		return *this;
+	}
+	~Model() { clear(); }
+
+	// deletes the meshes and GL objects while the context is still
+	// current
+	void clear()
+	{
+		meshes.clear();
+		for (const Texture &texture : textures_loaded)
+			glDeleteTextures(1, &texture.id);
+		textures_loaded.clear();
+		textureIndices.clear();
+		if (!buffers.empty())
+			glDeleteBuffers((GLsizei)buffers.size(),
+					buffers.data());
+		buffers.clear();
+		bufferBytes = 0;
 	}
 
 	// draws the model, and thus all its meshes
@@ -49,42 +126,345 @@ class Model
 			meshes[i].Draw(shader);
 	}
 
-	void SetShaderTextureNamePrefix(std::string prefix)
+	// draws the model with its meshes placed by their transforms, which
+	// .glb files can have, setting "model" for each
+	void Draw(Shader &shader, const glm::mat4 &model)
 	{
-		for (Mesh &mesh : meshes) {
-			mesh.glslIdentifierPrefix = prefix;
+		for (unsigned int i = 0; i < meshes.size(); i++) {
+			shader.setMat4("model", model * meshes[i].transform);
+			meshes[i].Draw(shader);
 		}
 	}
 
+	// world bounding box of the model drawn with the model matrix, empty
+	// (min > max) without meshes
+	void Bounds(const glm::mat4 &model, glm::vec3 &min,
+		    glm::vec3 &max) const
+	{
+		min = glm::vec3(INFINITY);
+		max = glm::vec3(-INFINITY);
+		for (const Mesh &mesh : meshes) {
+			glm::mat4 m = model * mesh.transform;
+			for (int corner = 0; corner < 8; corner++) {
+				glm::vec3 p = glm::vec3(
+				    m * glm::vec4(corner & 1 ? mesh.boundsMax.x
+							     : mesh.boundsMin.x,
+						  corner & 2 ? mesh.boundsMax.y
+							     : mesh.boundsMin.y,
+						  corner & 4 ? mesh.boundsMax.z
+							     : mesh.boundsMin.z,
+						  1.0f));
+				min = glm::min(min, p);
+				max = glm::max(max, p);
+			}
+		}
+	}
+
+	// the prefix of the sampler uniforms SetSamplerUnits sets
+	void SetShaderTextureNamePrefix(std::string prefix)
+	{
+		textureNamePrefix = prefix;
+	}
+
+	// points the shader's texture_diffuseN (and so on) samplers at the
+	// units the meshes bind their textures to, once per shader
+	void SetSamplerUnits(Shader &shader)
+	{
+		Mesh::SetSamplerUnits(shader, textureNamePrefix);
+	}
+
+	// .obj files are read by ObjLoader unless this is false, then they go
+	// through Assimp like every other format
+	static bool &nativeObj()
+	{
+		static bool native = true;
+		return native;
+	}
+
+	// .glb files are read by GlbLoader and uploaded as they are unless this
+	// is false
+	static bool &nativeGlb()
+	{
+		static bool native = true;
+		return native;
+	}
+
+	// whether the application has stb_image flip the images it decodes
+	// (stbi_set_flip_vertically_on_load), which stb_image can't be asked.
+	// GlbLoader keeps a .glb file's texture coordinates, where glTF puts
+	// the first row of an image at v = 0, so its images are turned back.
+	static bool &imagesFlippedOnLoad()
+	{
+		static bool flipped = false;
+		return flipped;
+	}
+
       private:
+	// a mesh converted from Assimp's or ObjLoader's layout, before it has
+	// GL buffers
+	struct MeshData {
+		vector<Vertex> vertices;
+		vector<unsigned int> indices;
+		// indices into textures_loaded
+		vector<unsigned int> textures;
+	};
+
 	// loads a model with supported ASSIMP extensions from file and stores
-	// the resulting meshes in the meshes vector.
-	void loadModel(string const &path)
+	// the resulting meshes in the meshes vector. The meshes are converted
+	// and the textures decoded in parallel jobs, then everything is
+	// uploaded to GL on the calling thread.
+	void loadModel(string const &path, JobSystem *jobs)
 	{
-		// read file via ASSIMP
+		CPU_ZONE("Model::loadModel");
+		auto start = std::chrono::steady_clock::now();
+		// retrieve the directory path of the filepath
+		directory = path.substr(0, path.find_last_of('/'));
+		// without a job system the jobs run right here in wait()
+		JobSystem serial(0);
+		JobSystem &system = jobs ? *jobs : serial;
+		JobCounter done;
+
+		vector<MeshData> data;
+		// owns the scene until its meshes are converted
 		Assimp::Importer importer;
-		const aiScene *scene = importer.ReadFile(
-		    path, aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-			      aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-		// check for errors
-		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
-		    !scene->mRootNode) // if is Not Zero
+		vector<const aiMesh *> order;
+		// owns the mapped file until it's uploaded
+		GlbLoader glb;
+		const char *route = " ";
+		// whether decoded images are turned back to how they're stored
+		bool flipBack = false;
+		if (hasExtension(path, ".obj") && nativeObj()) {
+			if (!loadObj(path, system, data))
+				return;
+			route = " (native OBJ) ";
+		} else if (hasExtension(path, ".glb") && nativeGlb()) {
+			if (!loadGlb(path, glb))
+				return;
+			route = " (native GLB) ";
+			flipBack = imagesFlippedOnLoad();
+		} else {
+			// read file via ASSIMP
+			const aiScene *scene;
+			{
+				CPU_ZONE("Assimp::ReadFile");
+				scene = importer.ReadFile(path, ASSIMP_FLAGS);
+			}
+			// check for errors
+			if (!scene ||
+			    scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
+			    !scene->mRootNode) // if is Not Zero
+			{
+				cout << "ERROR::ASSIMP:: "
+				     << importer.GetErrorString() << endl;
+				return;
+			}
+
+			// the meshes in the order of the node tree, with their
+			// textures looked up (and deduplicated) up front
+			processNode(scene->mRootNode, scene, order);
+			data.resize(order.size());
+			for (size_t i = 0; i < order.size(); i++) {
+				unsigned int m = order[i]->mMaterialIndex;
+				data[i].textures =
+				    findTextures(scene->mMaterials[m]);
+			}
+			for (size_t i = 0; i < order.size(); i++)
+				system.run(
+				    [&order, &data, i]() {
+					    processMesh(order[i], data[i]);
+				    },
+				    &done);
+		}
+		auto read = std::chrono::steady_clock::now();
+
+		vector<TextureImage> images(textures_loaded.size());
+		for (size_t i = 0; i < images.size(); i++)
+			system.run(
+			    [this, &images, i, flipBack]() {
+				    const EmbeddedImage &embedded =
+					embeddedImages[i];
+				    if (embedded.data)
+					    images[i] = DecodeTextureMemory(
+						embedded.data, embedded.size);
+				    else
+					    images[i] = DecodeTextureFile(
+						textures_loaded[i].path.c_str(),
+						directory);
+				    if (flipBack)
+					    FlipTextureRows(images[i]);
+			    },
+			    &done);
+		system.wait(done);
+		auto converted = std::chrono::steady_clock::now();
+
+		// GL objects are created on this thread, which owns the context
 		{
-			cout << "ERROR::ASSIMP:: " << importer.GetErrorString()
-			     << endl;
+			CPU_ZONE("Model::upload");
+			for (size_t i = 0; i < images.size(); i++)
+				textures_loaded[i].id = UploadTexture(
+				    images[i], textures_loaded[i].path.c_str());
+			if (!glb.primitives.empty())
+				uploadGlb(glb);
+			meshes.reserve(data.size());
+			for (MeshData &mesh : data) {
+				vector<Texture> textures;
+				textures.reserve(mesh.textures.size());
+				for (unsigned int texture : mesh.textures)
+					textures.push_back(
+					    textures_loaded[texture]);
+				bufferBytes +=
+				    mesh.vertices.size() * sizeof(Vertex) +
+				    mesh.indices.size() * sizeof(unsigned int);
+				meshes.emplace_back(std::move(mesh.vertices),
+						    std::move(mesh.indices),
+						    std::move(textures));
+			}
+		}
+		embeddedImages.clear();
+		auto uploaded = std::chrono::steady_clock::now();
+
+		size_t vertexCount = 0;
+		for (const Mesh &mesh : meshes)
+			vertexCount += mesh.vertexCount;
+		auto ms = [](std::chrono::steady_clock::duration d) {
+			return std::chrono::duration<double, std::milli>(d)
+			    .count();
+		};
+		std::cout << "Model " << path << ": " << meshes.size()
+			  << " meshes, " << vertexCount << " vertices, "
+			  << textures_loaded.size() << " textures on "
+			  << system.workerCount() + 1 << " threads; read"
+			  << route
+			  << ms(read - start) << " ms, convert "
+			  << ms(converted - read) << " ms, upload "
+			  << ms(uploaded - converted) << " ms" << std::endl;
+	}
+
+	// reads an OBJ file with ObjLoader, its meshes are ready to upload
+	bool loadObj(const string &path, JobSystem &jobs,
+		     vector<MeshData> &data)
+	{
+		ObjLoader loader;
+		if (!loader.load(path, jobs))
+			return false;
+		data.resize(loader.meshes.size());
+		for (size_t i = 0; i < data.size(); i++) {
+			ObjMesh &mesh = loader.meshes[i];
+			data[i].vertices = std::move(mesh.vertices);
+			data[i].indices = std::move(mesh.indices);
+			if (mesh.material < 0)
+				continue;
+			// the same maps and order as with Assimp
+			const ObjMaterial &material =
+			    loader.materials[mesh.material];
+			vector<unsigned int> &textures = data[i].textures;
+			if (!material.diffuse.empty())
+				addTexture(material.diffuse, TEXTURE_DIFFUSE,
+					   textures);
+			if (!material.specular.empty())
+				addTexture(material.specular,
+					   TEXTURE_SPECULAR, textures);
+			if (!material.normal.empty())
+				addTexture(material.normal, TEXTURE_NORMAL,
+					   textures);
+			if (!material.height.empty())
+				addTexture(material.height, TEXTURE_HEIGHT,
+					   textures);
+		}
+		return true;
+	}
+
+	// reads a .glb file with GlbLoader; the meshes are created by
+	// uploadGlb, straight from the mapped file
+	bool loadGlb(const string &path, GlbLoader &glb)
+	{
+		if (!glb.load(path))
+			return false;
+		string name = path.substr(path.find_last_of('/') + 1);
+		for (const GlbPrimitive &primitive : glb.primitives) {
+			vector<unsigned int> textures;
+			if (primitive.material >= 0) {
+				const GlbMaterial &material =
+				    glb.materials[primitive.material];
+				addGlbTexture(glb, name, material.diffuse,
+					      TEXTURE_DIFFUSE, textures);
+				addGlbTexture(glb, name, material.specular,
+					      TEXTURE_SPECULAR, textures);
+				addGlbTexture(glb, name, material.normal,
+					      TEXTURE_NORMAL, textures);
+			}
+			glbTextures.push_back(std::move(textures));
+		}
+		return true;
+	}
+
+	// embedded images are named after the file and their index, as in
+	// model.glb#2
+	void addGlbTexture(const GlbLoader &glb, const string &name, int image,
+			   TextureType type, vector<unsigned int> &textures)
+	{
+		if (image < 0)
 			return;
+		const GlbImage &source = glb.images[image];
+		if (source.data)
+			addTexture(name + '#' + std::to_string(image), type,
+				   textures, source.data, source.size);
+		else
+			addTexture(source.uri, type, textures);
+	}
+
+	// one GL buffer per buffer view that holds vertices or indices, filled
+	// from the mapped file, and a mesh per primitive reading from them
+	void uploadGlb(const GlbLoader &glb)
+	{
+		const vector<int> &views = glb.geometryViews();
+		size_t first = buffers.size();
+		buffers.resize(first + views.size());
+		glGenBuffers((GLsizei)views.size(), &buffers[first]);
+		std::unordered_map<int, unsigned int> viewBuffers;
+		for (size_t i = 0; i < views.size(); i++) {
+			size_t length = glb.views[views[i]].length;
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[first + i]);
+			glBufferData(GL_ARRAY_BUFFER, length,
+				     glb.viewData(views[i]), GL_STATIC_DRAW);
+			viewBuffers[views[i]] = buffers[first + i];
+			bufferBytes += length;
 		}
-		// retrieve the directory path of the filepath
-		directory = path.substr(0, path.find_last_of('/'));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		meshes.reserve(glb.primitives.size());
+		for (size_t i = 0; i < glb.primitives.size(); i++) {
+			const GlbPrimitive &p = glb.primitives[i];
+			vector<VertexAttribute> attributes;
+			for (const GlbAttribute &a : p.attributes)
+				attributes.push_back(
+				    {a.location, a.size, a.type, a.normalized,
+				     a.stride, a.offset, viewBuffers[a.view]});
+			vector<Texture> textures;
+			for (unsigned int texture : glbTextures[i])
+				textures.push_back(textures_loaded[texture]);
+			meshes.emplace_back(
+			    attributes, p.vertexCount,
+			    p.indexView >= 0 ? viewBuffers[p.indexView] : 0,
+			    p.indexType, p.indexOffset, p.count,
+			    std::move(textures));
+			meshes.back().transform = p.transform;
+			meshes.back().boundsMin = p.boundsMin;
+			meshes.back().boundsMax = p.boundsMax;
+		}
+		glbTextures.clear();
+	}
 
-		// process ASSIMP's root node recursively
-		processNode(scene->mRootNode, scene);
+	static bool hasExtension(const string &path, const char *extension)
+	{
+		size_t length = std::strlen(extension);
+		return path.size() > length &&
+		       path.compare(path.size() - length, length, extension) ==
+			   0;
 	}
 
-	// processes a node in a recursive fashion. Processes each individual
-	// mesh located at the node and repeats this process on its children
-	// nodes (if any).
-	void processNode(aiNode *node, const aiScene *scene)
+	// collects the meshes of a node and, recursively, of its children
+	void processNode(aiNode *node, const aiScene *scene,
+			 vector<const aiMesh *> &order)
 	{
 		// process each mesh located at the current node
 		for (unsigned int i = 0; i < node->mNumMeshes; i++) {
@@ -92,202 +472,237 @@ class Model
 			// actual objects in the scene. the scene contains all
 			// the data, node is just to keep stuff organized (like
 			// relations between nodes).
-			aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-			meshes.push_back(processMesh(mesh, scene));
+			order.push_back(scene->mMeshes[node->mMeshes[i]]);
 		}
 		// after we've processed all of the meshes (if any) we then
 		// recursively process each of the children nodes
 		for (unsigned int i = 0; i < node->mNumChildren; i++) {
-			processNode(node->mChildren[i], scene);
+			processNode(node->mChildren[i], scene, order);
 		}
 	}
 
-	Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+	// converts a mesh into pre-sized arrays, touches nothing but mesh and
+	// data so meshes can be converted in parallel
+	static void processMesh(const aiMesh *mesh, MeshData &data)
 	{
-		// data to fill
-		vector<Vertex> vertices;
-		vector<unsigned int> indices;
-		vector<Texture> textures;
-
+		CPU_ZONE("Model::processMesh");
+		vector<Vertex> &vertices = data.vertices;
+		vertices.resize(mesh->mNumVertices);
+		bool hasTexCoords = mesh->mTextureCoords[0] != nullptr;
 		// walk through each of the mesh's vertices
 		for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-			Vertex vertex;
-			glm::vec3
-			    vector; // we declare a placeholder vector since
-				    // assimp_ uses its own vector class that
-				    // doesn't directly convert to glm's vec3
-				    // class so we transfer the data to this
-				    // placeholder glm::vec3 first.
-			// positions
-			vector.x = mesh->mVertices[i].x;
-			vector.y = mesh->mVertices[i].y;
-			vector.z = mesh->mVertices[i].z;
-			vertex.Position = vector;
+			Vertex &vertex = vertices[i];
+			// assimp uses its own vector class that doesn't
+			// directly convert to glm's, so the components are
+			// copied one by one
+			vertex.Position =
+			    glm::vec3(mesh->mVertices[i].x,
+				      mesh->mVertices[i].y,
+				      mesh->mVertices[i].z);
 			// normals
-			if (mesh->HasNormals()) {
-				vector.x = mesh->mNormals[i].x;
-				vector.y = mesh->mNormals[i].y;
-				vector.z = mesh->mNormals[i].z;
-				vertex.Normal = vector;
-			}
+			if (mesh->HasNormals())
+				vertex.Normal = glm::vec3(mesh->mNormals[i].x,
+							  mesh->mNormals[i].y,
+							  mesh->mNormals[i].z);
 			// texture coordinates
-			if (mesh->mTextureCoords[0]) // does the mesh contain
-						     // texture coordinates?
-			{
-				glm::vec2 vec;
+			if (hasTexCoords) {
 				// a vertex can contain up to 8 different
 				// texture coordinates. We thus make the
 				// assumption that we won't use models where a
 				// vertex can have multiple texture coordinates
 				// so we always take the first set (0).
-				vec.x = mesh->mTextureCoords[0][i].x;
-				vec.y = mesh->mTextureCoords[0][i].y;
-				vertex.TexCoords = vec;
-				// tangent
-				vector.x = mesh->mTangents[i].x;
-				vector.y = mesh->mTangents[i].y;
-				vector.z = mesh->mTangents[i].z;
-				vertex.Tangent = vector;
-				// bitangent
-				vector.x = mesh->mBitangents[i].x;
-				vector.y = mesh->mBitangents[i].y;
-				vector.z = mesh->mBitangents[i].z;
-				vertex.Bitangent = vector;
+				vertex.TexCoords =
+				    glm::vec2(mesh->mTextureCoords[0][i].x,
+					      mesh->mTextureCoords[0][i].y);
+				vertex.Tangent =
+				    glm::vec3(mesh->mTangents[i].x,
+					      mesh->mTangents[i].y,
+					      mesh->mTangents[i].z);
+				vertex.Bitangent =
+				    glm::vec3(mesh->mBitangents[i].x,
+					      mesh->mBitangents[i].y,
+					      mesh->mBitangents[i].z);
 			} else
 				vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-
-			vertices.push_back(vertex);
 		}
-		// now wak through each of the mesh's faces (a face is a mesh
+		// now walk through each of the mesh's faces (a face is a mesh
 		// its triangle) and retrieve the corresponding vertex indices.
+		size_t indexCount = 0;
+		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+			indexCount += mesh->mFaces[i].mNumIndices;
+		vector<unsigned int> &indices = data.indices;
+		indices.resize(indexCount);
+		unsigned int *index = indices.data();
 		for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-			aiFace face = mesh->mFaces[i];
-			// retrieve all indices of the face and store them in
-			// the indices vector
+			const aiFace &face = mesh->mFaces[i];
 			for (unsigned int j = 0; j < face.mNumIndices; j++)
-				indices.push_back(face.mIndices[j]);
+				*index++ = face.mIndices[j];
 		}
-		// process materials
-		aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+	}
+
+	// the textures of a material as indices into textures_loaded
+	vector<unsigned int> findTextures(aiMaterial *material)
+	{
 		// we assume a convention for sampler names in the shaders. Each
 		// diffuse texture should be named as 'texture_diffuseN' where N
-		// is a sequential number ranging from 1 to MAX_SAMPLER_NUMBER.
-		// Same applies to other texture as the following list
-		// summarizes: diffuse: texture_diffuseN specular:
-		// texture_specularN normal: texture_normalN
-		aiColor3D color(0.0f, 0.0f, 0.0f);
-		material->Get(AI_MATKEY_COLOR_AMBIENT, color);
-
+		// is a sequential number ranging from 1 to
+		// MESH_TEXTURES_PER_TYPE. Same applies to other texture as the
+		// following list summarizes: diffuse: texture_diffuseN
+		// specular: texture_specularN normal: texture_normalN
+		vector<unsigned int> textures;
 		// 1. diffuse maps
-		vector<Texture> diffuseMaps = loadMaterialTextures(
-		    material, aiTextureType_DIFFUSE, "texture_diffuse");
-		textures.insert(textures.end(), diffuseMaps.begin(),
-				diffuseMaps.end());
+		findMaterialTextures(material, aiTextureType_DIFFUSE,
+				     TEXTURE_DIFFUSE, textures);
 		// 2. specular maps
-		vector<Texture> specularMaps = loadMaterialTextures(
-		    material, aiTextureType_SPECULAR, "texture_specular");
-		textures.insert(textures.end(), specularMaps.begin(),
-				specularMaps.end());
+		findMaterialTextures(material, aiTextureType_SPECULAR,
+				     TEXTURE_SPECULAR, textures);
 		// 3. normal maps
-		std::vector<Texture> normalMaps = loadMaterialTextures(
-		    material, aiTextureType_HEIGHT, "texture_normal");
-		textures.insert(textures.end(), normalMaps.begin(),
-				normalMaps.end());
+		findMaterialTextures(material, aiTextureType_HEIGHT,
+				     TEXTURE_NORMAL, textures);
 		// 4. height maps
-		std::vector<Texture> heightMaps = loadMaterialTextures(
-		    material, aiTextureType_AMBIENT, "texture_height");
-		textures.insert(textures.end(), heightMaps.begin(),
-				heightMaps.end());
-
-		// return a mesh object created from the extracted mesh data
-		return Mesh(vertices, indices, textures);
+		findMaterialTextures(material, aiTextureType_AMBIENT,
+				     TEXTURE_HEIGHT, textures);
+		return textures;
 	}
 
-	// checks all material textures of a given type and loads the textures
-	// if they're not loaded yet. the required info is returned as a Texture
-	// struct.
-	vector<Texture> loadMaterialTextures(aiMaterial *mat,
-					     aiTextureType type,
-					     string typeName)
+	// checks all material textures of a given type and adds the ones not
+	// seen yet to textures_loaded, to be decoded once for the entire model
+	void findMaterialTextures(aiMaterial *mat, aiTextureType aiType,
+				  TextureType type,
+				  vector<unsigned int> &textures)
 	{
-		vector<Texture> textures;
-		for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
+		for (unsigned int i = 0; i < mat->GetTextureCount(aiType);
+		     i++) {
 			aiString str;
-			mat->GetTexture(type, i, &str);
-			// check if texture was loaded before and if so,
-			// continue to next iteration: skip loading a new
-			// texture
-			bool skip = false;
-			for (unsigned int j = 0; j < textures_loaded.size();
-			     j++) {
-				if (std::strcmp(textures_loaded[j].path.data(),
-						str.C_Str()) == 0) {
-					textures.push_back(textures_loaded[j]);
-					skip = true; // a texture with the same
-						     // filepath has already
-						     // been loaded, continue to
-						     // next one. (optimization)
-					break;
-				}
-			}
-			if (!skip) { // if texture hasn't been loaded already,
-				     // load it
-				Texture texture;
-				texture.id = TextureFromFile(str.C_Str(),
-							     this->directory);
-				texture.type = typeName;
-				texture.path = str.C_Str();
-				textures.push_back(texture);
-				textures_loaded.push_back(
-				    texture); // store it as texture loaded for
-					      // entire model, to ensure we
-					      // won't unnecesery load duplicate
-					      // textures.
-			}
+			mat->GetTexture(aiType, i, &str);
+			addTexture(str.C_Str(), type, textures);
 		}
-		return textures;
+	}
+
+	// adds the texture at path (relative to the model) to textures unless
+	// it's already there
+	void addTexture(const string &path, TextureType type,
+			vector<unsigned int> &textures,
+			const unsigned char *data = nullptr, size_t size = 0)
+	{
+		auto seen = textureIndices.find(path);
+		if (seen != textureIndices.end()) {
+			textures.push_back(seen->second);
+			return;
+		}
+		Texture texture;
+		texture.id = 0;
+		texture.type = type;
+		texture.path = path;
+		textureIndices[path] = (unsigned int)textures_loaded.size();
+		textures.push_back((unsigned int)textures_loaded.size());
+		textures_loaded.push_back(texture);
+		embeddedImages.push_back({data, size});
+	}
+
+	// path of every texture in textures_loaded to its index
+	std::unordered_map<string, unsigned int> textureIndices;
+
+	// the encoded bytes of each texture in textures_loaded that's inside
+	// the model file, while loading
+	struct EmbeddedImage {
+		const unsigned char *data;
+		size_t size;
+	};
+	vector<EmbeddedImage> embeddedImages;
+	// the textures of each primitive of a .glb file, while loading
+	vector<vector<unsigned int>> glbTextures;
+	// GL buffers holding a .glb file's buffer views, shared by its meshes
+	vector<unsigned int> buffers;
+	string textureNamePrefix;
+
+	void take(Model &other)
+	{
+		textures_loaded = std::move(other.textures_loaded);
+		meshes = std::move(other.meshes);
+		directory = std::move(other.directory);
+		gammaCorrection = other.gammaCorrection;
+		bufferBytes = other.bufferBytes;
+		textureIndices = std::move(other.textureIndices);
+		buffers = std::move(other.buffers);
+		textureNamePrefix = std::move(other.textureNamePrefix);
+		// a moved-from vector is only guaranteed to be valid, the
+		// handles mustn't be deleted twice
+		other.textures_loaded.clear();
+		other.meshes.clear();
+		other.buffers.clear();
+		other.bufferBytes = 0;
 	}
 };
 
 unsigned int TextureFromFile(const char *path, const string &directory,
 			     bool gamma)
 {
+	CPU_ZONE("TextureFromFile");
+	TextureImage image = DecodeTextureFile(path, directory);
+	return UploadTexture(image, path);
+}
+
+TextureImage DecodeTextureMemory(const unsigned char *data, size_t size)
+{
+	CPU_ZONE("DecodeTextureMemory");
+	TextureImage image;
+	image.data = stbi_load_from_memory(data, (int)size, &image.width,
+					   &image.height, &image.nrComponents,
+					   0);
+	return image;
+}
+
+TextureImage DecodeTextureFile(const char *path, const string &directory)
+{
+	CPU_ZONE("DecodeTextureFile");
 	string filename = string(path);
 	filename = directory + '/' + filename;
 
+	TextureImage image;
+	image.data = stbi_load(filename.c_str(), &image.width, &image.height,
+			       &image.nrComponents, 0);
+	return image;
+}
+
+void FlipTextureRows(TextureImage &image)
+{
+	if (!image.data)
+		return;
+	size_t row = (size_t)image.width * image.nrComponents;
+	unsigned char *top = image.data;
+	unsigned char *bottom = image.data + (image.height - 1) * row;
+	for (; top < bottom; top += row, bottom -= row)
+		std::swap_ranges(top, top + row, bottom);
+}
+
+unsigned int UploadTexture(TextureImage &image, const char *path)
+{
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
 
-	int width, height, nrComponents;
-	unsigned char *data =
-	    stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-	if (data) {
+	if (image.data) {
 		GLenum format;
-		if (nrComponents == 1)
+		if (image.nrComponents == 1)
 			format = GL_RED;
-		else if (nrComponents == 3)
+		else if (image.nrComponents == 3)
 			format = GL_RGB;
-		else if (nrComponents == 4)
+		else if (image.nrComponents == 4)
 			format = GL_RGBA;
 
 		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format,
-			     GL_UNSIGNED_BYTE, data);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, image.width,
+			     image.height, 0, format, GL_UNSIGNED_BYTE,
+			     image.data);
 		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-				GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-				GL_LINEAR);
-
-		stbi_image_free(data);
+		// filtering and wrapping come from the sampler bound at draw
+		// time (see SamplerCache)
 	} else {
 		std::cout << "Texture failed to load at path: " << path
 			  << std::endl;
-		stbi_image_free(data);
 	}
+	stbi_image_free(image.data);
+	image.data = nullptr;
 
 	return textureID;
 }
@@ -0,0 +1,111 @@
+#ifndef MODEL_BENCHMARK_H
+#define MODEL_BENCHMARK_H
+
+#include <learnopengl/benchmark_runs.h>
+#include <learnopengl/job_system.h>
+#include <learnopengl/memory_usage.h>
+#include <learnopengl/model.h>
+
+#include <cstdio>
+#include <string>
+
+// Loads a model into a Model through its native loader (ObjLoader or
+// GlbLoader) and through Assimp, each with and without keeping the CPU copy
+// of the vertices, run by --model-benchmark once the context exists.
+//
+// - ms: reading, converting, decoding textures and uploading to GL
+// - CPU KB / GL KB: vertex and index data the meshes keep on the CPU and
+//   what went into GL buffers
+// - peak MB / kept MB: the process' resident memory at its highest during
+//   the load and once it's done, over what it was before. The peak is only
+//   measured per load where the kernel can reset it (MemoryUsage), and
+//   freed memory isn't always returned to the system, so these are upper
+//   bounds; the driver's copies of buffers and textures count too.
+class ModelBenchmark
+{
+      public:
+	static const int REPETITIONS = 3;
+
+	bool run(const std::string &path, JobSystem &jobs)
+	{
+		std::printf("Model benchmark: %s, median of %d loads\n",
+			    path.c_str(), REPETITIONS);
+		if (!MemoryUsage::resetPeak())
+			std::printf("(peak memory can't be reset, it's the "
+				    "highest so far)\n");
+		std::printf("%-16s %7s %9s %9s %10s %10s %8s %8s\n", "route",
+			    "meshes", "vertices", "ms", "CPU KB", "GL KB",
+			    "peak MB", "kept MB");
+		bool obj = Model::nativeObj(), glb = Model::nativeGlb();
+		Result native = measure("native", path, jobs, true);
+		measure("native, no copy", path, jobs, false);
+		Model::nativeObj() = Model::nativeGlb() = false;
+		Result assimp = measure("Assimp", path, jobs, true);
+		measure("Assimp, no copy", path, jobs, false);
+		Model::nativeObj() = obj;
+		Model::nativeGlb() = glb;
+
+		if (native.meshes == 0)
+			return false;
+		if (assimp.meshes > 0 && native.ms > 0.0)
+			std::printf("native loads %.2fx faster\n",
+				    assimp.ms / native.ms);
+		return true;
+	}
+
+      private:
+	struct Result {
+		double ms = 0.0;
+		size_t meshes = 0;
+		size_t vertices = 0;
+		size_t cpuBytes = 0;
+		size_t glBytes = 0;
+		double peakMB = 0.0;
+		double keptMB = 0.0;
+	};
+
+	static double megabytes(size_t after, size_t before)
+	{
+		return after > before ? (after - before) / 1048576.0 : 0.0;
+	}
+
+	static Result measure(const char *route, const std::string &path,
+			      JobSystem &jobs, bool keepCpuCopy)
+	{
+		Result result;
+		// the memory is read around the load, a few microseconds of
+		// the time
+		auto load = [&]() {
+			MemoryUsage::resetPeak();
+			size_t before = MemoryUsage::residentBytes();
+			Model model(path, false, &jobs, keepCpuCopy);
+			result = Result();
+			result.peakMB = megabytes(
+			    MemoryUsage::peakResidentBytes(), before);
+			result.keptMB =
+			    megabytes(MemoryUsage::residentBytes(), before);
+			result.meshes = model.meshes.size();
+			for (const Mesh &mesh : model.meshes) {
+				result.vertices += mesh.vertexCount;
+				result.cpuBytes +=
+				    mesh.vertices.capacity() * sizeof(Vertex) +
+				    mesh.indices.capacity() *
+					sizeof(unsigned int);
+			}
+			result.glBytes = model.bufferBytes;
+			return true;
+		};
+		BenchmarkRuns::median(REPETITIONS, load, result.ms);
+
+		if (result.meshes == 0)
+			std::printf("%-16s failed to load the model\n", route);
+		else
+			std::printf(
+			    "%-16s %7zu %9zu %9.2f %10.1f %10.1f %8.1f %8.1f\n",
+			    route, result.meshes, result.vertices, result.ms,
+			    result.cpuBytes / 1024.0, result.glBytes / 1024.0,
+			    result.peakMB, result.keptMB);
+		return result;
+	}
+};
+#endif
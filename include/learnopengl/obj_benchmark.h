@@ -0,0 +1,103 @@
+#ifndef OBJ_BENCHMARK_H
+#define OBJ_BENCHMARK_H
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <learnopengl/benchmark_runs.h>
+#include <learnopengl/job_system.h>
+#include <learnopengl/model.h>
+#include <learnopengl/obj_loader.h>
+
+#include <cstdio>
+#include <string>
+
+// Compares ObjLoader with Assimp on an OBJ file, run by --obj-benchmark.
+// Both produce triangulated meshes with normals and tangents, Assimp with
+// the post-processing Model asks it for; neither time includes textures or
+// GL uploads. ObjLoader runs with 1, 2, 4, ... threads up to the core count
+// or --job-threads, Assimp on one.
+class ObjBenchmark
+{
+      public:
+	static const int REPETITIONS = 5;
+
+	// maxThreads = 0 goes up to the core count
+	bool run(const std::string &path, unsigned int maxThreads = 0)
+	{
+		MappedFile file;
+		if (!file.open(path)) {
+			std::printf("ERROR::OBJ_BENCHMARK::FILE_NOT_FOUND: "
+				    "%s\n",
+				    path.c_str());
+			return false;
+		}
+		double megabytes = file.size() / (1024.0 * 1024.0);
+		std::printf("OBJ benchmark: %s, %.1f MB, median of %d runs\n",
+			    path.c_str(), megabytes, REPETITIONS);
+		std::printf("%-10s %8s %8s %10s %10s %10s %9s\n", "loader",
+			    "threads", "meshes", "vertices", "triangles",
+			    "ms", "MB/s");
+
+		double assimp = 0.0;
+		{
+			size_t meshes = 0, vertices = 0, triangles = 0;
+			auto load = [&]() {
+				Assimp::Importer importer;
+				const aiScene *scene = importer.ReadFile(
+				    path, Model::ASSIMP_FLAGS);
+				if (!scene)
+					return false;
+				meshes = scene->mNumMeshes;
+				vertices = triangles = 0;
+				for (unsigned int m = 0; m < meshes; m++) {
+					vertices +=
+					    scene->mMeshes[m]->mNumVertices;
+					triangles +=
+					    scene->mMeshes[m]->mNumFaces;
+				}
+				return true;
+			};
+			if (BenchmarkRuns::median(REPETITIONS, load, assimp))
+				print("Assimp", 1, meshes, vertices, triangles,
+				      assimp, megabytes);
+			else
+				std::printf("%-10s failed to load the file\n",
+					    "Assimp");
+		}
+
+		for (unsigned int threads :
+		     BenchmarkRuns::threadCounts(maxThreads)) {
+			JobSystem jobs((int)threads - 1);
+			ObjLoader loader;
+			double ms;
+			if (!BenchmarkRuns::median(
+				REPETITIONS,
+				[&]() { return loader.load(path, jobs); }, ms))
+				return false;
+			size_t vertices = 0, triangles = 0;
+			for (const ObjMesh &mesh : loader.meshes) {
+				vertices += mesh.vertices.size();
+				triangles += mesh.indices.size() / 3;
+			}
+			print("ObjLoader", threads, loader.meshes.size(),
+			      vertices, triangles, ms, megabytes);
+			if (assimp > 0.0)
+				std::printf("%-10s %8s %.2fx faster than "
+					    "Assimp\n",
+					    "", "", assimp / ms);
+		}
+		return true;
+	}
+
+      private:
+	static void print(const char *loader, unsigned int threads,
+			  size_t meshes, size_t vertices, size_t triangles,
+			  double ms, double megabytes)
+	{
+		std::printf("%-10s %8u %8zu %10zu %10zu %10.2f %9.1f\n",
+			    loader, threads, meshes, vertices, triangles, ms,
+			    ms > 0.0 ? megabytes * 1000.0 / ms : 0.0);
+	}
+};
+#endif
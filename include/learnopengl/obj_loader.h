@@ -0,0 +1,642 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/job_system.h>
+#include <learnopengl/mapped_file.h>
+#include <learnopengl/mesh.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// the texture maps of an MTL material, paths relative to the OBJ file
+struct ObjMaterial {
+	std::string name;
+	std::string diffuse;  // map_Kd
+	std::string specular; // map_Ks
+	std::string normal;   // map_Bump / bump, a height map by name
+	std::string height;   // map_Ka
+};
+
+struct ObjMesh {
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	// index into ObjLoader::materials, -1 for none
+	int material;
+};
+
+// Loads Wavefront OBJ/MTL files into Vertex and index arrays without going
+// through Assimp, producing what Model gets from Assimp with its usual
+// post-processing (triangulated, identical vertices joined, smooth normals
+// where the file has none, flipped texture coordinates, tangents and
+// bitangents).
+//
+// The file is memory-mapped and cut into chunks at line boundaries which
+// are parsed in parallel jobs. Face indices can only be resolved once every
+// chunk knows how many positions came before it, so chunks keep them raw and
+// a serial pass stitches the chunks together into meshes (a new one for
+// every o/g/usemtl). Each mesh is then built in a job of its own: face
+// corners are deduplicated through a hash map of their (v, vt, vn) triples
+// into the vertex array.
+class ObjLoader
+{
+      public:
+	std::vector<ObjMesh> meshes;
+	std::vector<ObjMaterial> materials;
+
+	bool load(const std::string &path, JobSystem &jobs)
+	{
+		CPU_ZONE("ObjLoader::load");
+		meshes.clear();
+		materials.clear();
+		MappedFile file;
+		if (!file.open(path)) {
+			std::cout << "ERROR::OBJ::FILE_NOT_FOUND: " << path
+				  << std::endl;
+			return false;
+		}
+		std::string directory = path.substr(0, path.find_last_of('/'));
+
+		// chunks of about CHUNK_SIZE bytes ending at a newline
+		std::vector<Chunk> chunks;
+		const char *begin = file.data();
+		const char *fileEnd = begin + file.size();
+		while (begin < fileEnd) {
+			size_t left = fileEnd - begin;
+			const char *end =
+			    begin + (left < CHUNK_SIZE ? left : CHUNK_SIZE);
+			while (end < fileEnd && end[-1] != '\n')
+				end++;
+			chunks.emplace_back();
+			chunks.back().begin = begin;
+			chunks.back().end = end;
+			begin = end;
+		}
+		JobCounter parsed;
+		for (Chunk &chunk : chunks)
+			jobs.run([&chunk]() { parse(chunk); }, &parsed);
+		jobs.wait(parsed);
+
+		for (const Chunk &chunk : chunks)
+			for (const std::string &library : chunk.libraries)
+				loadMaterials(directory + '/' + library);
+		std::vector<Segment> segments = stitch(chunks);
+
+		JobCounter built;
+		meshes.resize(segments.size());
+		for (size_t i = 0; i < segments.size(); i++)
+			jobs.run(
+			    [this, &segments, &chunks, i]() {
+				    build(segments[i], chunks, meshes[i]);
+			    },
+			    &built);
+		jobs.wait(built);
+		std::vector<glm::vec3>().swap(positions);
+		std::vector<glm::vec2>().swap(texCoords);
+		std::vector<glm::vec3>().swap(normals);
+		meshes.erase(std::remove_if(meshes.begin(), meshes.end(),
+					    [](const ObjMesh &mesh) {
+						    return mesh.indices.empty();
+					    }),
+			     meshes.end());
+		return true;
+	}
+
+	// parses a decimal floating point number at p, returns the end of
+	// it; faster than strtof since it ignores the locale and reads the
+	// digits into one integer instead of going through long double
+	static const char *parseFloat(const char *p, const char *end,
+				      float &out)
+	{
+		static const double POWERS[] = {
+		    1e0,  1e1,	1e2,  1e3,  1e4,  1e5,	1e6,  1e7,
+		    1e8,  1e9,	1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+		    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+		unsigned long long mantissa = 0;
+		int exponent = 0, digits = 0;
+		for (; p < end && unsigned(*p - '0') < 10; p++) {
+			if (digits++ < 19)
+				mantissa = mantissa * 10 + (*p - '0');
+			else
+				exponent++;
+		}
+		if (p < end && *p == '.') {
+			for (p++; p < end && unsigned(*p - '0') < 10; p++) {
+				if (digits++ < 19) {
+					mantissa = mantissa * 10 + (*p - '0');
+					exponent--;
+				}
+			}
+		}
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char *q = p + 1;
+			bool negativeExponent = false;
+			if (q < end && (*q == '-' || *q == '+'))
+				negativeExponent = *q++ == '-';
+			if (q < end && unsigned(*q - '0') < 10) {
+				int e = 0;
+				for (; q < end && unsigned(*q - '0') < 10; q++)
+					e = std::min(e * 10 + (*q - '0'), 9999);
+				exponent += negativeExponent ? -e : e;
+				p = q;
+			}
+		}
+		double value = (double)mantissa;
+		if (exponent < 0 && exponent >= -22)
+			value /= POWERS[-exponent];
+		else if (exponent > 0 && exponent <= 22)
+			value *= POWERS[exponent];
+		else if (exponent != 0)
+			value *= std::pow(10.0, exponent);
+		out = (float)(negative ? -value : value);
+		return p;
+	}
+
+      private:
+	static const size_t CHUNK_SIZE = 1 << 20;
+	// a face corner's index that isn't there (v//vn has no vt)
+	static const int NONE = INT_MIN;
+	// negative (relative) indices in the file are stored as RELATIVE plus
+	// the index counted from the chunk's first element
+	static const int RELATIVE = -(1 << 30);
+
+	// indices of a face corner: >= 0 is a 0-based index into the whole
+	// file, otherwise see NONE and RELATIVE
+	struct Corner {
+		int v, vt, vn;
+	};
+
+	// where a chunk starts a new mesh
+	struct Start {
+		size_t corner;
+		// empty when only the object or group changes
+		std::string material;
+		bool hasMaterial;
+	};
+
+	struct Chunk {
+		const char *begin;
+		const char *end;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> texCoords;
+		std::vector<glm::vec3> normals;
+		// three per triangle
+		std::vector<Corner> corners;
+		std::vector<Start> starts;
+		std::vector<std::string> libraries;
+		// elements before this chunk, filled in by stitch
+		int positionBase = 0, texCoordBase = 0, normalBase = 0;
+	};
+
+	// the elements of all chunks, filled in by stitch
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+
+	// the corners of one mesh, possibly spread over several chunks
+	struct Segment {
+		int material;
+		// (chunk, first corner, end corner)
+		struct Range {
+			size_t chunk, begin, end;
+		};
+		std::vector<Range> ranges;
+	};
+
+	static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+	static const char *skipSpaces(const char *p, const char *end)
+	{
+		while (p < end && isSpace(*p))
+			p++;
+		return p;
+	}
+
+	static const char *lineEnd(const char *p, const char *end)
+	{
+		const char *newline = (const char *)memchr(p, '\n', end - p);
+		return newline ? newline : end;
+	}
+
+	// the rest of the line without surrounding whitespace
+	static std::string restOfLine(const char *p, const char *end)
+	{
+		p = skipSpaces(p, end);
+		while (end > p && (isSpace(end[-1]) || end[-1] == '\r'))
+			end--;
+		return std::string(p, end);
+	}
+
+	static const char *parseIndex(const char *p, const char *end,
+				      int count, int &index)
+	{
+		bool negative = p < end && *p == '-';
+		if (negative)
+			p++;
+		if (p >= end || unsigned(*p - '0') >= 10) {
+			index = NONE;
+			return p;
+		}
+		int value = 0;
+		for (; p < end && unsigned(*p - '0') < 10; p++)
+			value = value * 10 + (*p - '0');
+		if (value == 0)
+			index = NONE;
+		else if (negative)
+			// counts back from the last element so far, which may
+			// be in an earlier chunk
+			index = RELATIVE + (count - value);
+		else
+			index = value - 1;
+		return p;
+	}
+
+	static void parse(Chunk &chunk)
+	{
+		CPU_ZONE("ObjLoader::parse");
+		// rough reservations, a third of the lines are usually faces
+		size_t lines = (chunk.end - chunk.begin) / 32;
+		chunk.positions.reserve(lines / 2);
+		chunk.corners.reserve(lines * 2);
+		std::vector<Corner> polygon;
+		const char *p = chunk.begin;
+		while (p < chunk.end) {
+			p = skipSpaces(p, chunk.end);
+			const char *end = lineEnd(p, chunk.end);
+			if (end - p > 2 && p[0] == 'v' && isSpace(p[1])) {
+				glm::vec3 v;
+				const char *q = p + 2;
+				for (int i = 0; i < 3; i++)
+					q = parseFloat(skipSpaces(q, end), end,
+						       v[i]);
+				chunk.positions.push_back(v);
+			} else if (end - p > 3 && p[0] == 'v' && p[1] == 't' &&
+				   isSpace(p[2])) {
+				glm::vec2 vt(0.0f);
+				const char *q = p + 3;
+				for (int i = 0; i < 2; i++)
+					q = parseFloat(skipSpaces(q, end), end,
+						       vt[i]);
+				chunk.texCoords.push_back(vt);
+			} else if (end - p > 3 && p[0] == 'v' && p[1] == 'n' &&
+				   isSpace(p[2])) {
+				glm::vec3 vn;
+				const char *q = p + 3;
+				for (int i = 0; i < 3; i++)
+					q = parseFloat(skipSpaces(q, end), end,
+						       vn[i]);
+				chunk.normals.push_back(vn);
+			} else if (end - p > 2 && p[0] == 'f' &&
+				   isSpace(p[1])) {
+				parseFace(chunk, p + 2, end, polygon);
+			} else if (startsWith(p, end, "usemtl")) {
+				chunk.starts.push_back(
+				    {chunk.corners.size(),
+				     restOfLine(p + 6, end), true});
+			} else if ((p[0] == 'o' || p[0] == 'g') &&
+				   (end - p == 1 || isSpace(p[1]))) {
+				chunk.starts.push_back(
+				    {chunk.corners.size(), "", false});
+			} else if (startsWith(p, end, "mtllib")) {
+				chunk.libraries.push_back(
+				    restOfLine(p + 6, end));
+			}
+			p = end + 1;
+		}
+	}
+
+	static bool startsWith(const char *p, const char *end,
+			       const char *keyword)
+	{
+		size_t n = strlen(keyword);
+		return (size_t)(end - p) > n && !memcmp(p, keyword, n) &&
+		       isSpace(p[n]);
+	}
+
+	// reads a polygon's corners and adds it as a triangle fan
+	static void parseFace(Chunk &chunk, const char *p, const char *end,
+			      std::vector<Corner> &polygon)
+	{
+		polygon.clear();
+		for (;;) {
+			p = skipSpaces(p, end);
+			if (p >= end || (unsigned(*p - '0') >= 10 && *p != '-'))
+				break;
+			Corner c = {NONE, NONE, NONE};
+			p = parseIndex(p, end, (int)chunk.positions.size(),
+				       c.v);
+			if (p < end && *p == '/') {
+				p = parseIndex(p + 1, end,
+					       (int)chunk.texCoords.size(),
+					       c.vt);
+				if (p < end && *p == '/')
+					p = parseIndex(
+					    p + 1, end,
+					    (int)chunk.normals.size(), c.vn);
+			}
+			if (c.v == NONE)
+				break;
+			polygon.push_back(c);
+		}
+		for (size_t i = 2; i < polygon.size(); i++) {
+			chunk.corners.push_back(polygon[0]);
+			chunk.corners.push_back(polygon[i - 1]);
+			chunk.corners.push_back(polygon[i]);
+		}
+	}
+
+	void loadMaterials(const std::string &path)
+	{
+		std::ifstream in(path);
+		if (!in) {
+			std::cout << "ERROR::OBJ::MTL_NOT_FOUND: " << path
+				  << std::endl;
+			return;
+		}
+		std::string line;
+		while (std::getline(in, line)) {
+			const char *p = line.c_str();
+			const char *end = p + line.size();
+			p = skipSpaces(p, end);
+			std::string *map = nullptr;
+			size_t keyword = 0;
+			if (startsWith(p, end, "newmtl")) {
+				materials.push_back(ObjMaterial());
+				materials.back().name = restOfLine(p + 6, end);
+			} else if (materials.empty()) {
+				continue;
+			} else if (startsWith(p, end, "map_Kd")) {
+				map = &materials.back().diffuse;
+				keyword = 6;
+			} else if (startsWith(p, end, "map_Ks")) {
+				map = &materials.back().specular;
+				keyword = 6;
+			} else if (startsWith(p, end, "map_Bump") ||
+				   startsWith(p, end, "map_bump")) {
+				map = &materials.back().normal;
+				keyword = 8;
+			} else if (startsWith(p, end, "bump")) {
+				map = &materials.back().normal;
+				keyword = 4;
+			} else if (startsWith(p, end, "map_Ka")) {
+				map = &materials.back().height;
+				keyword = 6;
+			}
+			// options like -bm 1.0 come before the file name
+			if (map) {
+				std::string value =
+				    restOfLine(p + keyword, end);
+				size_t space = value.find_last_of(" \t");
+				*map = space == std::string::npos
+					   ? value
+					   : value.substr(space + 1);
+			}
+		}
+	}
+
+	int findMaterial(const std::string &name) const
+	{
+		for (size_t i = 0; i < materials.size(); i++)
+			if (materials[i].name == name)
+				return (int)i;
+		return -1;
+	}
+
+	// resolves the element counts before each chunk, gathers the
+	// elements and cuts the corners into meshes
+	std::vector<Segment> stitch(std::vector<Chunk> &chunks)
+	{
+		std::vector<Segment> segments(1);
+		segments[0].material = -1;
+		int positionCount = 0, texCoordCount = 0, normalCount = 0;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			Chunk &chunk = chunks[i];
+			chunk.positionBase = positionCount;
+			chunk.texCoordBase = texCoordCount;
+			chunk.normalBase = normalCount;
+			positionCount += (int)chunk.positions.size();
+			texCoordCount += (int)chunk.texCoords.size();
+			normalCount += (int)chunk.normals.size();
+
+			size_t begin = 0;
+			for (const Start &start : chunk.starts) {
+				add(segments.back(), i, begin, start.corner);
+				begin = start.corner;
+				int material =
+				    start.hasMaterial
+					? findMaterial(start.material)
+					: segments.back().material;
+				// o/g or a different material start a mesh,
+				// unless the current one has no faces yet
+				if (!segments.back().ranges.empty())
+					segments.emplace_back();
+				segments.back().material = material;
+			}
+			add(segments.back(), i, begin, chunk.corners.size());
+		}
+		gather(chunks, &Chunk::positions, positions);
+		gather(chunks, &Chunk::texCoords, texCoords);
+		gather(chunks, &Chunk::normals, normals);
+		return segments;
+	}
+
+	template <typename T>
+	static void gather(std::vector<Chunk> &chunks,
+			   std::vector<T> Chunk::*elements, std::vector<T> &all)
+	{
+		size_t count = 0;
+		for (const Chunk &chunk : chunks)
+			count += (chunk.*elements).size();
+		all.clear();
+		all.reserve(count);
+		for (Chunk &chunk : chunks) {
+			all.insert(all.end(), (chunk.*elements).begin(),
+				   (chunk.*elements).end());
+			std::vector<T>().swap(chunk.*elements);
+		}
+	}
+
+	static void add(Segment &segment, size_t chunk, size_t begin,
+			size_t end)
+	{
+		if (begin < end)
+			segment.ranges.push_back({chunk, begin, end});
+	}
+
+	struct CornerHash {
+		size_t operator()(const Corner &c) const
+		{
+			size_t h =
+			    (size_t)(unsigned)c.v * 0x9E3779B97F4A7C15ull;
+			h ^= (size_t)(unsigned)c.vt + 0x632BE59BD9B4E019ull +
+			     (h << 6) + (h >> 2);
+			h ^= (size_t)(unsigned)c.vn + 0x85EBCA77C2B2AE63ull +
+			     (h << 6) + (h >> 2);
+			return h;
+		}
+	};
+	struct CornerEqual {
+		bool operator()(const Corner &a, const Corner &b) const
+		{
+			return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+		}
+	};
+
+	// a corner index resolved to the whole file
+	static int resolve(int index, int base)
+	{
+		return index == NONE || index >= 0 ? index
+						   : base + (index - RELATIVE);
+	}
+
+	template <typename T>
+	static const T *element(int index, const std::vector<T> &all)
+	{
+		return index >= 0 && index < (int)all.size() ? &all[index]
+							     : nullptr;
+	}
+
+	void build(const Segment &segment, const std::vector<Chunk> &chunks,
+		   ObjMesh &mesh) const
+	{
+		CPU_ZONE("ObjLoader::build");
+		mesh.material = segment.material;
+		size_t cornerCount = 0;
+		for (const Segment::Range &range : segment.ranges)
+			cornerCount += range.end - range.begin;
+		mesh.indices.resize(cornerCount);
+		mesh.vertices.reserve(cornerCount / 2);
+
+		// corners with file-wide indices to their vertex
+		std::unordered_map<Corner, unsigned int, CornerHash,
+				   CornerEqual>
+		    unique(cornerCount / 2);
+		// the position index of every vertex, for smooth normals
+		std::vector<int> positionOf;
+		positionOf.reserve(cornerCount / 2);
+		bool hasNormals = true, hasTexCoords = true;
+		size_t next = 0;
+		for (const Segment::Range &range : segment.ranges) {
+			const Chunk &chunk = chunks[range.chunk];
+			for (size_t i = range.begin; i < range.end; i++) {
+				Corner c = chunk.corners[i];
+				c.v = resolve(c.v, chunk.positionBase);
+				c.vt = resolve(c.vt, chunk.texCoordBase);
+				c.vn = resolve(c.vn, chunk.normalBase);
+				auto found = unique.emplace(
+				    c, (unsigned int)mesh.vertices.size());
+				mesh.indices[next++] = found.first->second;
+				if (!found.second)
+					continue;
+
+				Vertex vertex;
+				const glm::vec3 *v = element(c.v, positions);
+				const glm::vec2 *vt =
+				    element(c.vt, texCoords);
+				const glm::vec3 *vn = element(c.vn, normals);
+				vertex.Position = v ? *v : glm::vec3(0.0f);
+				// Assimp's FlipUVs
+				vertex.TexCoords =
+				    vt ? glm::vec2((*vt).x, 1.0f - (*vt).y)
+				       : glm::vec2(0.0f);
+				vertex.Normal = vn ? *vn : glm::vec3(0.0f);
+				vertex.Tangent = glm::vec3(0.0f);
+				vertex.Bitangent = glm::vec3(0.0f);
+				hasNormals = hasNormals && vn;
+				hasTexCoords = hasTexCoords && vt;
+				mesh.vertices.push_back(vertex);
+				positionOf.push_back(c.v);
+			}
+		}
+		// the reserve above guesses high, Model may keep the array
+		mesh.vertices.shrink_to_fit();
+		if (!hasNormals)
+			smoothNormals(mesh, positionOf);
+		if (hasTexCoords)
+			tangents(mesh);
+	}
+
+	// the unweighted average of the normals of the faces around each
+	// position, like Assimp's GenSmoothNormals
+	static void smoothNormals(ObjMesh &mesh,
+				  const std::vector<int> &positionOf)
+	{
+		std::unordered_map<int, glm::vec3> sums;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			const unsigned int *t = &mesh.indices[i];
+			glm::vec3 n = faceNormal(mesh, t);
+			for (int j = 0; j < 3; j++)
+				sums[positionOf[t[j]]] += n;
+		}
+		for (size_t i = 0; i < mesh.vertices.size(); i++) {
+			glm::vec3 n = sums[positionOf[i]];
+			float length = glm::length(n);
+			mesh.vertices[i].Normal =
+			    length > 0.0f ? n / length : glm::vec3(0.0f);
+		}
+	}
+
+	static glm::vec3 faceNormal(const ObjMesh &mesh,
+				    const unsigned int *t)
+	{
+		glm::vec3 e1 = mesh.vertices[t[1]].Position -
+			       mesh.vertices[t[0]].Position;
+		glm::vec3 e2 = mesh.vertices[t[2]].Position -
+			       mesh.vertices[t[0]].Position;
+		glm::vec3 n = glm::cross(e1, e2);
+		float length = glm::length(n);
+		return length > 0.0f ? n / length : glm::vec3(0.0f);
+	}
+
+	// per-vertex tangents and bitangents from the texture coordinates,
+	// like Assimp's CalcTangentSpace
+	static void tangents(ObjMesh &mesh)
+	{
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			const unsigned int *t = &mesh.indices[i];
+			const Vertex &a = mesh.vertices[t[0]];
+			const Vertex &b = mesh.vertices[t[1]];
+			const Vertex &c = mesh.vertices[t[2]];
+			glm::vec3 e1 = b.Position - a.Position;
+			glm::vec3 e2 = c.Position - a.Position;
+			glm::vec2 d1 = b.TexCoords - a.TexCoords;
+			glm::vec2 d2 = c.TexCoords - a.TexCoords;
+			float det = d1.x * d2.y - d2.x * d1.y;
+			if (std::fabs(det) < 1e-12f)
+				continue;
+			float r = 1.0f / det;
+			glm::vec3 tangent = (e1 * d2.y - e2 * d1.y) * r;
+			glm::vec3 bitangent = (e2 * d1.x - e1 * d2.x) * r;
+			for (int j = 0; j < 3; j++) {
+				mesh.vertices[t[j]].Tangent += tangent;
+				mesh.vertices[t[j]].Bitangent += bitangent;
+			}
+		}
+		for (Vertex &v : mesh.vertices) {
+			// orthogonalize against the normal
+			glm::vec3 n = v.Normal;
+			glm::vec3 tangent =
+			    v.Tangent - n * glm::dot(n, v.Tangent);
+			glm::vec3 bitangent =
+			    v.Bitangent - n * glm::dot(n, v.Bitangent);
+			float tl = glm::length(tangent);
+			float bl = glm::length(bitangent);
+			v.Tangent = tl > 0.0f ? tangent / tl : glm::vec3(0.0f);
+			v.Bitangent =
+			    bl > 0.0f ? bitangent / bl : glm::vec3(0.0f);
+		}
+	}
+};
+#endif
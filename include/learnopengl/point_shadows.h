@@ -0,0 +1,323 @@
+#ifndef POINT_SHADOWS_H
+#define POINT_SHADOWS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Omnidirectional shadows of point lights in depth cube maps that store the
+// distance to the light over its range. A light's faces are drawn in a
+// single pass: the geometry shader of resources/shaders/point_shadow_depth.*
+// sends every triangle to the faces in its faceMask uniform with gl_Layer.
+//
+// Faces are only redrawn when they're dirty: their light moved or changed
+// range, or a caster moved into or out of their frustum (touch()). At most
+// a budget of faces is drawn per frame, taking turns over all the lights'
+// faces, so many shadowed lights or a caster moving through many faces
+// spread their cost over frames instead of spiking one; a face waiting for
+// its turn keeps its old shadow.
+//
+//     shadows.setLight(0, position, range);
+//     shadows.touch(oldMin, oldMax); // for every caster that moved
+//     shadows.touch(newMin, newMax);
+//     shadows.schedule(budget);
+//     shadows.beginPass();
+//     for (int i = 0; i < shadows.count(); i++)
+//             if (shadows.begin(i)) {
+//                     shadows.setCasterUniforms(depthShader, i);
+//                     draw every caster
+//             }
+//     shadows.endPass();
+class PointShadows
+{
+      public:
+	static const int MAX_LIGHTS = 4;
+	static const int FACES = 6;
+
+	PointShadows() = default;
+	PointShadows(const PointShadows &) = delete;
+	PointShadows &operator=(const PointShadows &) = delete;
+
+	// (re)creates the maps, nothing happens while count and resolution
+	// stay the same
+	void configure(int count, int resolution)
+	{
+		if (count > MAX_LIGHTS)
+			count = MAX_LIGHTS;
+		count = std::max(1, count);
+		if (count == lights && resolution == size)
+			return;
+		clear();
+		lights = count;
+		size = resolution;
+		glGenTextures(lights, textures);
+		glGenFramebuffers(lights, layeredFBOs);
+		glGenFramebuffers(lights * FACES, faceFBOs);
+		for (int i = 0; i < lights; i++) {
+			glBindTexture(GL_TEXTURE_CUBE_MAP, textures[i]);
+			for (int face = 0; face < FACES; face++)
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X +
+						 face,
+					     0, GL_DEPTH_COMPONENT24, size,
+					     size, 0, GL_DEPTH_COMPONENT,
+					     GL_FLOAT, nullptr);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP,
+					GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP,
+					GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			// every face at once to draw, one at a time to clear
+			glBindFramebuffer(GL_FRAMEBUFFER, layeredFBOs[i]);
+			glFramebufferTexture(GL_FRAMEBUFFER,
+					     GL_DEPTH_ATTACHMENT, textures[i],
+					     0);
+			complete(i);
+			for (int face = 0; face < FACES; face++) {
+				glBindFramebuffer(GL_FRAMEBUFFER,
+						  faceFBOs[i * FACES + face]);
+				glFramebufferTexture2D(
+				    GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+				    GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+				    textures[i], 0);
+				complete(i);
+			}
+		}
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		invalidate();
+	}
+
+	// deletes the maps, must be called while the context is current
+	void clear()
+	{
+		if (lights == 0)
+			return;
+		glDeleteFramebuffers(lights * FACES, faceFBOs);
+		glDeleteFramebuffers(lights, layeredFBOs);
+		glDeleteTextures(lights, textures);
+		lights = 0;
+		size = 0;
+	}
+
+	// every face is redrawn
+	void invalidate()
+	{
+		for (int i = 0; i < MAX_LIGHTS; i++)
+			dirty[i] = ALL_FACES;
+	}
+
+	// places a light, moving it or changing its range dirties all of its
+	// faces
+	void setLight(int light, glm::vec3 position, float range)
+	{
+		if (position != positions[light] || range != ranges[light])
+			dirty[light] = ALL_FACES;
+		positions[light] = position;
+		ranges[light] = range;
+	}
+
+	// world bounds a caster left or moved into, the faces they reach
+	// are redrawn; empty bounds (min > max) reach nothing
+	void touch(glm::vec3 boundsMin, glm::vec3 boundsMax)
+	{
+		if (boundsMin.x > boundsMax.x)
+			return;
+		for (int i = 0; i < lights; i++)
+			for (int face = 0; face < FACES; face++)
+				if (reaches(face, boundsMin - positions[i],
+					    boundsMax - positions[i],
+					    ranges[i]))
+					dirty[i] |= 1 << face;
+	}
+
+	// picks the dirty faces drawn this frame, at most budget of them,
+	// going on from the face after the last one drawn so every face gets
+	// its turn
+	void schedule(int budget)
+	{
+		scheduledFaces = 0;
+		for (int i = 0; i < MAX_LIGHTS; i++)
+			scheduled[i] = 0;
+		int slots = lights * FACES;
+		for (int k = 0; k < slots && scheduledFaces < budget; k++) {
+			int slot = (cursor + k) % slots;
+			int light = slot / FACES, bit = 1 << (slot % FACES);
+			if (!(dirty[light] & bit))
+				continue;
+			dirty[light] &= ~bit;
+			scheduled[light] |= bit;
+			scheduledFaces++;
+			if (scheduledFaces == budget)
+				cursor = (slot + 1) % slots;
+		}
+	}
+
+	// state of the shadow pass
+	void beginPass()
+	{
+		glDisable(GL_CULL_FACE);
+		glViewport(0, 0, size, size);
+	}
+	void endPass()
+	{
+		glEnable(GL_CULL_FACE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	// clears the light's scheduled faces and binds them to draw the
+	// casters into, false when none are due
+	bool begin(int light)
+	{
+		if (!scheduled[light])
+			return false;
+		for (int face = 0; face < FACES; face++)
+			if (scheduled[light] & (1 << face)) {
+				glBindFramebuffer(
+				    GL_FRAMEBUFFER,
+				    faceFBOs[light * FACES + face]);
+				glClear(GL_DEPTH_BUFFER_BIT);
+				faceRedraws++;
+			}
+		glBindFramebuffer(GL_FRAMEBUFFER, layeredFBOs[light]);
+		return true;
+	}
+
+	// sets up a depth shader (point_shadow_depth.*) to draw the casters
+	// into the faces begin() bound
+	void setCasterUniforms(Shader &shader, int light) const
+	{
+		static const char *const faceNames[FACES] = {
+		    "faceMatrices[0]", "faceMatrices[1]", "faceMatrices[2]",
+		    "faceMatrices[3]", "faceMatrices[4]", "faceMatrices[5]"};
+		// the cube map's face orientations
+		static const glm::vec3 directions[FACES] = {
+		    {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+		    {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+		    {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}};
+		static const glm::vec3 ups[FACES] = {
+		    {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+		    {0.0f, 0.0f, 1.0f},	 {0.0f, 0.0f, -1.0f},
+		    {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}};
+		glm::vec3 position = positions[light];
+		glm::mat4 projection = glm::perspective(
+		    glm::radians(90.0f), 1.0f, NEAR_PLANE, ranges[light]);
+		shader.use();
+		for (int face = 0; face < FACES; face++)
+			shader.setMat4(faceNames[face],
+				       projection *
+					   glm::lookAt(position,
+						       position +
+							   directions[face],
+						       ups[face]));
+		shader.setInt("faceMask", scheduled[light]);
+		shader.setVec3("lightPosition", position);
+		shader.setFloat("range", ranges[light]);
+	}
+
+	// sets the uniforms of include/point_shadows.glsl for a light, its
+	// map is bound to the pointShadowMap unit by the caller
+	void setUniforms(Shader &shader, int light) const
+	{
+		shader.setFloat("pointShadowRange", ranges[light]);
+	}
+
+	// the distance where a light's attenuation falls below 5/256, past it
+	// the light adds nothing visible and casts no shadow
+	static float attenuationRange(float constant, float linear,
+				      float quadratic)
+	{
+		float c = constant - 256.0f / 5.0f;
+		float range = MAX_RANGE;
+		if (quadratic > 0.0f)
+			range = (-linear + std::sqrt(linear * linear -
+						     4.0f * quadratic * c)) /
+				(2.0f * quadratic);
+		else if (linear > 0.0f)
+			range = -c / linear;
+		if (range > MAX_RANGE)
+			range = MAX_RANGE;
+		return std::max(NEAR_PLANE * 2.0f, range);
+	}
+
+	int count() const { return lights; }
+	int resolution() const { return size; }
+	unsigned int texture(int light) const { return textures[light]; }
+	// faces drawn this frame and faces still waiting for their turn
+	int scheduledCount() const { return scheduledFaces; }
+	int pendingCount() const
+	{
+		int pending = 0;
+		for (int i = 0; i < lights; i++)
+			for (int face = 0; face < FACES; face++)
+				pending += (dirty[i] >> face) & 1;
+		return pending;
+	}
+	// how many faces were drawn so far
+	unsigned long faceRedrawCount() const { return faceRedraws; }
+
+      private:
+	static const int ALL_FACES = (1 << FACES) - 1;
+	static constexpr float NEAR_PLANE = 0.05f;
+	static constexpr float MAX_RANGE = 100.0f;
+
+	int lights = 0;
+	int size = 0;
+	unsigned int textures[MAX_LIGHTS] = {};
+	unsigned int layeredFBOs[MAX_LIGHTS] = {};
+	unsigned int faceFBOs[MAX_LIGHTS * FACES] = {};
+	glm::vec3 positions[MAX_LIGHTS];
+	float ranges[MAX_LIGHTS] = {};
+	// a bit per face
+	int dirty[MAX_LIGHTS] = {};
+	int scheduled[MAX_LIGHTS] = {};
+	int scheduledFaces = 0;
+	// the light * FACES + face scheduling goes on from
+	int cursor = 0;
+	unsigned long faceRedraws = 0;
+
+	// whether a box, relative to the light, reaches into the face's
+	// frustum: a 90 degree pyramid along the face's axis out to range.
+	// Conservative, a box near an edge may count without being inside.
+	static bool reaches(int face, glm::vec3 boxMin, glm::vec3 boxMax,
+			    float range)
+	{
+		// the largest dot(n, p) over the box
+		auto extent = [&](glm::vec3 n) {
+			glm::vec3 a = n * boxMin, b = n * boxMax;
+			return std::max(a.x, b.x) + std::max(a.y, b.y) +
+			       std::max(a.z, b.z);
+		};
+		int axis = face / 2;
+		glm::vec3 forward(0.0f);
+		forward[axis] = face & 1 ? -1.0f : 1.0f;
+		if (extent(-forward) < -range)
+			return false;
+		// the four sides, where the distance along the axis equals
+		// the one across it
+		for (int other = 1; other < 3; other++) {
+			glm::vec3 across(0.0f);
+			across[(axis + other) % 3] = 1.0f;
+			if (extent(forward + across) < 0.0f ||
+			    extent(forward - across) < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	// a depth-only framebuffer, bound
+	static void complete(int light)
+	{
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+		    GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::POINT_SHADOWS::FRAMEBUFFER: light "
+				  << light << " not complete" << std::endl;
+	}
+};
+#endif
@@ -0,0 +1,177 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/filesystem.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+// GL_ARB_get_program_binary is core only since 4.1, the 3.3 loader doesn't
+// know about it so the entry points are fetched by hand.
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+typedef void(APIENTRYP PFNGETPROGRAMBINARYPROC)(GLuint program,
+						GLsizei bufSize,
+						GLsizei *length,
+						GLenum *binaryFormat,
+						void *binary);
+typedef void(APIENTRYP PFNPROGRAMBINARYPROC)(GLuint program,
+					     GLenum binaryFormat,
+					     const void *binary,
+					     GLsizei length);
+typedef void(APIENTRYP PFNPROGRAMPARAMETERIPROC)(GLuint program,
+						 GLenum pname, GLint value);
+
+// On-disk cache of linked program binaries. Entries are keyed by a hash of
+// the shader sources together with the driver's vendor, renderer and version
+// strings, so a driver update never sees a binary it didn't produce. The
+// driver may still reject a binary, in which case the entry is dropped and
+// the caller compiles from source.
+class ProgramCache
+{
+      public:
+	// fetches the program binary entry points, must be called once after
+	// the GL loader ran; without it (or without driver support) every
+	// lookup misses
+	static void init(GLADloadproc load)
+	{
+		State &s = state();
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		// older drivers without the extension raise INVALID_ENUM
+		while (glGetError() != GL_NO_ERROR)
+			;
+		s.getProgramBinary =
+		    (PFNGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+		s.programBinary = (PFNPROGRAMBINARYPROC)load("glProgramBinary");
+		s.programParameteri =
+		    (PFNPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+		s.enabled = formats > 0 && s.getProgramBinary &&
+			    s.programBinary && s.programParameteri;
+		if (!s.enabled)
+			return;
+
+		s.driver = std::string((const char *)glGetString(GL_VENDOR)) +
+			   '|' + (const char *)glGetString(GL_RENDERER) + '|' +
+			   (const char *)glGetString(GL_VERSION);
+		s.directory = FileSystem::getPath("shader_cache");
+		mkdir(s.directory.c_str(), 0755);
+	}
+
+	static bool enabled() { return state().enabled; }
+
+	// 64-bit FNV-1a over all sources and the driver identification
+	static unsigned long long key(const std::vector<std::string> &sources)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		for (const std::string &source : sources) {
+			hash = fnv1a(hash, source.data(), source.size());
+			hash = fnv1a(hash, "\0", 1);
+		}
+		const std::string &driver = state().driver;
+		return fnv1a(hash, driver.data(), driver.size());
+	}
+
+	// must be called before linking a program that will be stored
+	static void markRetrievable(GLuint program)
+	{
+		if (enabled())
+			state().programParameteri(
+			    program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+			    GL_TRUE);
+	}
+
+	// loads the cached binary into program, returns false on a miss or
+	// when the driver rejects the binary (the stale entry is removed)
+	static bool load(unsigned long long key, GLuint program)
+	{
+		if (!enabled())
+			return false;
+		std::ifstream in(path(key), std::ios::binary);
+		if (!in)
+			return false;
+		GLenum format;
+		if (!in.read((char *)&format, sizeof(format)))
+			return false;
+		std::vector<char> binary((std::istreambuf_iterator<char>(in)),
+					 std::istreambuf_iterator<char>());
+		in.close();
+
+		state().programBinary(program, format, binary.data(),
+				      (GLsizei)binary.size());
+		GLint success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success) {
+			std::cout << "ProgramCache: driver rejected cached "
+				     "binary, recompiling"
+				  << std::endl;
+			std::remove(path(key).c_str());
+			return false;
+		}
+		return true;
+	}
+
+	// writes the binary of a successfully linked program to the cache
+	static void store(unsigned long long key, GLuint program)
+	{
+		if (!enabled())
+			return;
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+		std::vector<char> binary(length);
+		GLenum format;
+		state().getProgramBinary(program, length, nullptr, &format,
+					 binary.data());
+
+		std::ofstream out(path(key), std::ios::binary);
+		out.write((const char *)&format, sizeof(format));
+		out.write(binary.data(), binary.size());
+	}
+
+      private:
+	struct State {
+		bool enabled = false;
+		std::string driver;
+		std::string directory;
+		PFNGETPROGRAMBINARYPROC getProgramBinary = nullptr;
+		PFNPROGRAMBINARYPROC programBinary = nullptr;
+		PFNPROGRAMPARAMETERIPROC programParameteri = nullptr;
+	};
+
+	static State &state()
+	{
+		static State s;
+		return s;
+	}
+
+	static std::string path(unsigned long long key)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "/%016llx.bin", key);
+		return state().directory + name;
+	}
+
+	static unsigned long long fnv1a(unsigned long long hash,
+					const char *data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++) {
+			hash ^= (unsigned char)data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+};
+#endif
@@ -0,0 +1,145 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <learnopengl/cpu_profiler.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Runs the rendering of a frame on a thread of its own that owns the GL
+// context, while the main thread handles the window, input and simulation
+// of the next frame. The main thread describes each frame in a Packet and
+// submits it; packets are double-buffered, so the main thread can be one
+// frame ahead of the render thread but never more.
+//
+// Packets are only ever destroyed on the main thread (submit() swaps the
+// new packet for one the render thread is done with), which keeps anything
+// that isn't thread-safe to free, like ImGui draw lists, off the render
+// thread. Filling the returned packet again reuses what it allocated.
+template <typename Packet> class RenderThread
+{
+      public:
+	// milliseconds of the last frame
+	struct Timing {
+		float mainWait;	  // main thread blocked in submit()
+		float renderWait; // render thread waiting for a packet
+		float renderBusy; // render thread rendering
+	};
+
+	RenderThread() = default;
+	RenderThread(const RenderThread &) = delete;
+	RenderThread &operator=(const RenderThread &) = delete;
+	~RenderThread() { stop(); }
+
+	// attach runs first on the new thread (make the context current),
+	// render for every packet, detach last (release the context)
+	void start(std::function<void()> attach,
+		   std::function<void(Packet &)> render,
+		   std::function<void()> detach)
+	{
+		stopping = false;
+		thread = std::thread([this, attach, render, detach]() {
+			CpuProfiler::setThreadName("render");
+			attach();
+			run(render);
+			detach();
+		});
+	}
+
+	bool running() const { return thread.joinable(); }
+
+	// hands the next frame to the render thread, waits while the previous
+	// one hasn't been picked up yet; packet is left holding a rendered one
+	void submit(Packet &packet)
+	{
+		CPU_ZONE("RenderThread::submit");
+		long long start = now();
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this]() { return !pending; });
+		std::swap(next, packet);
+		pending = true;
+		timing.mainWait = (now() - start) / 1.0e6f;
+		changed.notify_all();
+	}
+
+	// waits until every submitted frame is rendered
+	void waitIdle()
+	{
+		CPU_ZONE("RenderThread::waitIdle");
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this]() { return !pending && !busy; });
+	}
+
+	// renders the frame still pending and joins the thread
+	void stop()
+	{
+		if (!thread.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			changed.notify_all();
+		}
+		thread.join();
+		// the packets die here, on the thread that stops this one
+		next = Packet();
+		current = Packet();
+	}
+
+	Timing lastTiming() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return timing;
+	}
+
+      private:
+	std::thread thread;
+	mutable std::mutex mutex;
+	std::condition_variable changed;
+	// next is filled by submit, current is the one being rendered
+	Packet next;
+	Packet current;
+	bool pending = false;
+	bool busy = false;
+	bool stopping = false;
+	Timing timing = {0.0f, 0.0f, 0.0f};
+
+	static long long now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		    .count();
+	}
+
+	void run(const std::function<void(Packet &)> &render)
+	{
+		for (;;) {
+			long long waitStart = now();
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [this]() {
+					return pending || stopping;
+				});
+				if (!pending)
+					return;
+				std::swap(next, current);
+				pending = false;
+				busy = true;
+				timing.renderWait =
+				    (now() - waitStart) / 1.0e6f;
+				changed.notify_all();
+			}
+			long long renderStart = now();
+			render(current);
+			std::lock_guard<std::mutex> lock(mutex);
+			busy = false;
+			timing.renderBusy = (now() - renderStart) / 1.0e6f;
+			changed.notify_all();
+		}
+	}
+};
+#endif
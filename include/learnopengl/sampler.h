@@ -0,0 +1,196 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <map>
+
+// anisotropic filtering is an extension in GL 3.3 (EXT/ARB share the enums)
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+enum SamplerFilter {
+	SAMPLER_NEAREST,   // no filtering, no mipmaps (render targets)
+	SAMPLER_LINEAR,    // bilinear, no mipmaps (cubemaps)
+	SAMPLER_BILINEAR,  // bilinear, nearest mip level
+	SAMPLER_TRILINEAR, // bilinear, blended between mip levels
+};
+
+// Global filtering quality for material textures, ordered from cheapest to
+// most expensive in texture bandwidth.
+enum TextureQuality {
+	TEXTURE_QUALITY_BILINEAR,
+	TEXTURE_QUALITY_TRILINEAR,
+	TEXTURE_QUALITY_ANISOTROPIC_2X,
+	TEXTURE_QUALITY_ANISOTROPIC_4X,
+	TEXTURE_QUALITY_ANISOTROPIC_8X,
+	TEXTURE_QUALITY_ANISOTROPIC_16X,
+	TEXTURE_QUALITY_COUNT
+};
+
+const char *const TEXTURE_QUALITY_NAMES[TEXTURE_QUALITY_COUNT] = {
+    "Bilinear",	      "Trilinear",	 "Anisotropic 2x",
+    "Anisotropic 4x", "Anisotropic 8x", "Anisotropic 16x"};
+
+// Creates sampler objects on demand and keeps them keyed by filter, wrap mode
+// and anisotropy so that textures carry no filtering state of their own. The
+// sampling state is chosen per texture unit with glBindSampler instead.
+class SamplerCache
+{
+      public:
+	// returns the sampler for the given state, creating it the first time
+	unsigned int get(SamplerFilter filter, GLenum wrap,
+			 float anisotropy = 1.0f)
+	{
+		if (anisotropy > maxAnisotropy())
+			anisotropy = maxAnisotropy();
+		if (anisotropy < 1.0f)
+			anisotropy = 1.0f;
+
+		unsigned long long key = (unsigned long long)filter << 48 |
+					 (unsigned long long)wrap << 16 |
+					 (unsigned long long)anisotropy;
+		std::map<unsigned long long, unsigned int>::iterator it =
+		    samplers.find(key);
+		if (it != samplers.end())
+			return it->second;
+
+		unsigned int sampler;
+		glGenSamplers(1, &sampler);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, wrap);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, wrap);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, wrap);
+		glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER,
+				    minFilter(filter));
+		glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER,
+				    filter == SAMPLER_NEAREST ? GL_NEAREST
+							      : GL_LINEAR);
+		if (anisotropy > 1.0f)
+			glSamplerParameterf(sampler,
+					    GL_TEXTURE_MAX_ANISOTROPY_EXT,
+					    anisotropy);
+		samplers[key] = sampler;
+		return sampler;
+	}
+
+	// sampler for mipmapped material textures, follows the global quality
+	unsigned int material(GLenum wrap = GL_REPEAT)
+	{
+		switch (textureQuality) {
+		case TEXTURE_QUALITY_BILINEAR:
+			return get(SAMPLER_BILINEAR, wrap);
+		case TEXTURE_QUALITY_TRILINEAR:
+			return get(SAMPLER_TRILINEAR, wrap);
+		default:
+			return get(SAMPLER_TRILINEAR, wrap,
+				   (float)(1 << (textureQuality -
+						 TEXTURE_QUALITY_TRILINEAR)));
+		}
+	}
+
+	// depth comparison sampler for shadow maps: the hardware filters 2x2
+	// comparisons, and everything outside the map is lit
+	unsigned int shadow()
+	{
+		if (shadowSampler == 0) {
+			const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+			glGenSamplers(1, &shadowSampler);
+			glSamplerParameteri(shadowSampler, GL_TEXTURE_WRAP_S,
+					    GL_CLAMP_TO_BORDER);
+			glSamplerParameteri(shadowSampler, GL_TEXTURE_WRAP_T,
+					    GL_CLAMP_TO_BORDER);
+			glSamplerParameterfv(shadowSampler,
+					     GL_TEXTURE_BORDER_COLOR, white);
+			glSamplerParameteri(shadowSampler,
+					    GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glSamplerParameteri(shadowSampler,
+					    GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glSamplerParameteri(shadowSampler,
+					    GL_TEXTURE_COMPARE_MODE,
+					    GL_COMPARE_REF_TO_TEXTURE);
+			glSamplerParameteri(shadowSampler,
+					    GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		}
+		return shadowSampler;
+	}
+
+	// units 0 to units - 1 go back to their textures' own state; every
+	// pass ends with it for the units it bound, so no pass (or ImGui)
+	// samples with a sampler left behind by the one before
+	static void unbind(unsigned int units)
+	{
+		for (unsigned int unit = 0; unit < units; unit++)
+			glBindSampler(unit, 0);
+	}
+
+	TextureQuality quality() const { return textureQuality; }
+	void setQuality(TextureQuality quality) { textureQuality = quality; }
+
+	// 1.0 when anisotropic filtering isn't supported by the driver
+	float maxAnisotropy()
+	{
+		if (maxSupportedAnisotropy == 0.0f) {
+			maxSupportedAnisotropy = 1.0f;
+			if (anisotropySupported())
+				glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT,
+					    &maxSupportedAnisotropy);
+		}
+		return maxSupportedAnisotropy;
+	}
+
+	// deletes all samplers, must be called while the context is current
+	void clear()
+	{
+		for (auto &entry : samplers)
+			glDeleteSamplers(1, &entry.second);
+		samplers.clear();
+		if (shadowSampler)
+			glDeleteSamplers(1, &shadowSampler);
+		shadowSampler = 0;
+	}
+
+      private:
+	std::map<unsigned long long, unsigned int> samplers;
+	TextureQuality textureQuality = TEXTURE_QUALITY_ANISOTROPIC_4X;
+	float maxSupportedAnisotropy = 0.0f;
+	unsigned int shadowSampler = 0;
+
+	static GLenum minFilter(SamplerFilter filter)
+	{
+		switch (filter) {
+		case SAMPLER_NEAREST:
+			return GL_NEAREST;
+		case SAMPLER_LINEAR:
+			return GL_LINEAR;
+		case SAMPLER_BILINEAR:
+			return GL_LINEAR_MIPMAP_NEAREST;
+		case SAMPLER_TRILINEAR:
+			return GL_LINEAR_MIPMAP_LINEAR;
+		}
+		return GL_LINEAR;
+	}
+
+	static bool anisotropySupported()
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++) {
+			const char *name =
+			    (const char *)glGetStringi(GL_EXTENSIONS, i);
+			if (std::strcmp(name,
+					"GL_EXT_texture_filter_anisotropic") ==
+				0 ||
+			    std::strcmp(name,
+					"GL_ARB_texture_filter_anisotropic") ==
+				0)
+				return true;
+		}
+		return false;
+	}
+};
+#endif
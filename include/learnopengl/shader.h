@@ -4,11 +4,31 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/program_cache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <common.h>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
+// permutation switches a shader is built with, every entry is added to all
+// stages as "#define NAME value"
+typedef std::vector<std::pair<std::string, int>> ShaderDefines;
+
+// GL_KHR_parallel_shader_compile (and the ARB one, with the same enum) lets
+// the driver compile and link in the background until this status is true
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 class Shader
 {
       public:
@@ -16,167 +36,404 @@ class Shader
 	// constructor generates the shader on the fly
 	// ------------------------------------------------------------------------
 	Shader(const char *vertexPath, const char *fragmentPath,
-	       const char *geometryPath = nullptr)
+	       const char *geometryPath = nullptr,
+	       const ShaderDefines &defines = ShaderDefines())
+	    : vertexPath(vertexPath), fragmentPath(fragmentPath),
+	      geometryPath(geometryPath ? geometryPath : ""), defines(defines)
 	{
-		std::string vertexPathString(vertexPath);
-		std::string fragmentPathString(fragmentPath);
-
-		vertexPath = vertexPathString.c_str();
-		fragmentPath = fragmentPathString.c_str();
-		// 1. retrieve the vertex/fragment source code from filePath
-		std::string vertexCode;
-		std::string fragmentCode;
-		std::string geometryCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
-		std::ifstream gShaderFile;
-		// ensure ifstream objects can throw exceptions:
-		vShaderFile.exceptions(std::ifstream::failbit |
-				       std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::failbit |
-				       std::ifstream::badbit);
-		gShaderFile.exceptions(std::ifstream::failbit |
-				       std::ifstream::badbit);
-		try {
-			// open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// read file's buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
-			// convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
-			// if geometry shader path is present, also load a
-			// geometry shader
-			if (geometryPath != nullptr) {
-				std::string geometryPathString(geometryPath);
-				geometryPath = geometryPathString.c_str();
-				gShaderFile.open(geometryPath);
-				std::stringstream gShaderStream;
-				gShaderStream << gShaderFile.rdbuf();
-				gShaderFile.close();
-				geometryCode = gShaderStream.str();
-			}
-		} catch (std::ifstream::failure &e) {
-			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ"
-				  << std::endl;
-		}
-		const char *vShaderCode = vertexCode.c_str();
-		const char *fShaderCode = fragmentCode.c_str();
-		// 2. compile shaders
-		unsigned int vertex, fragment;
-		// vertex shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		checkCompileErrors(vertex, "VERTEX");
-		// fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		checkCompileErrors(fragment, "FRAGMENT");
-		// if geometry shader is given, compile geometry shader
-		unsigned int geometry;
-		if (geometryPath != nullptr) {
-			const char *gShaderCode = geometryCode.c_str();
-			geometry = glCreateShader(GL_GEOMETRY_SHADER);
-			glShaderSource(geometry, 1, &gShaderCode, NULL);
-			glCompileShader(geometry);
-			checkCompileErrors(geometry, "GEOMETRY");
+		Build build = startBuild();
+		finishBuild(build);
+		ID = build.program;
+	}
+	// starts rebuilding the program from the (edited) source files. The
+	// old program stays in use: the driver compiles and links the new one,
+	// in the background where it supports parallel compiles, until
+	// reloadReady(); finishReload() then swaps it in. Starting again
+	// before that drops the build in progress.
+	// ------------------------------------------------------------------------
+	void beginReload()
+	{
+		if (reloading)
+			abandonBuild(pending);
+		pending = startBuild();
+		reloading = true;
+	}
+	// whether finishReload() can run without waiting for the driver
+	// ------------------------------------------------------------------------
+	bool reloadReady() const
+	{
+		if (!reloading || pending.cached ||
+		    !parallelCompileSupported())
+			return reloading;
+		GLint done = GL_FALSE;
+		glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR,
+			       &done);
+		return done;
+	}
+	// on success the uniforms set so far are carried over to the new
+	// program and it replaces the old one, otherwise the old program is
+	// kept; returns whether the new one was swapped in
+	// ------------------------------------------------------------------------
+	bool finishReload()
+	{
+		if (!reloading)
+			return false;
+		reloading = false;
+		if (!finishBuild(pending)) {
+			glDeleteProgram(pending.program);
+			return false;
 		}
-		// shader Program
-		ID = glCreateProgram();
-		glAttachShader(ID, vertex);
-		glAttachShader(ID, fragment);
-		if (geometryPath != nullptr)
-			glAttachShader(ID, geometry);
-		glLinkProgram(ID);
-		checkCompileErrors(ID, "PROGRAM");
-		// delete the shaders as they're linked into our program now and
-		// no longer necessery
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
-		if (geometryPath != nullptr)
-			glDeleteShader(geometry);
+		copyUniforms(ID, pending.program);
+		glDeleteProgram(ID);
+		ID = pending.program;
+		return true;
+	}
+	// the sources and defines, for messages
+	// ------------------------------------------------------------------------
+	std::string name() const
+	{
+		std::string result = vertexPath + " + " + fragmentPath;
+		if (!geometryPath.empty())
+			result += " + " + geometryPath;
+		for (const auto &define : defines)
+			result += " " + define.first + "=" +
+				  std::to_string(define.second);
+		return result;
+	}
+	// whether the canonical path names one of the files the program was
+	// built from, including the #included ones
+	// ------------------------------------------------------------------------
+	bool dependsOn(const std::string &path) const
+	{
+		return std::find(dependencies.begin(), dependencies.end(),
+				 path) != dependencies.end();
 	}
 	// activate the shader
 	// ------------------------------------------------------------------------
 	void use() { glUseProgram(ID); }
-	// utility uniform functions
+	// utility uniform functions, the names are plain C strings so that
+	// setting a uniform never builds a std::string
 	// ------------------------------------------------------------------------
-	void setBool(const std::string &name, bool value) const
+	void setBool(const char *name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+		glUniform1i(glGetUniformLocation(ID, name), (int)value);
 	}
 	// ------------------------------------------------------------------------
-	void setInt(const std::string &name, int value) const
+	void setInt(const char *name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+		glUniform1i(glGetUniformLocation(ID, name), value);
 	}
 	// ------------------------------------------------------------------------
-	void setFloat(const std::string &name, float value) const
+	void setFloat(const char *name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+		glUniform1f(glGetUniformLocation(ID, name), value);
 	}
 	// ------------------------------------------------------------------------
-	void setVec2(const std::string &name, const glm::vec2 &value) const
+	void setVec2(const char *name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1,
-			     &value[0]);
+		glUniform2fv(glGetUniformLocation(ID, name), 1, &value[0]);
 	}
-	void setVec2(const std::string &name, float x, float y) const
+	void setVec2(const char *name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+		glUniform2f(glGetUniformLocation(ID, name), x, y);
 	}
 	// ------------------------------------------------------------------------
-	void setVec3(const std::string &name, const glm::vec3 &value) const
+	void setVec3(const char *name, const glm::vec3 &value) const
 	{
-		glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1,
-			     &value[0]);
+		glUniform3fv(glGetUniformLocation(ID, name), 1, &value[0]);
 	}
-	void setVec3(const std::string &name, float x, float y, float z) const
+	void setVec3(const char *name, float x, float y, float z) const
 	{
-		glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+		glUniform3f(glGetUniformLocation(ID, name), x, y, z);
 	}
 	// ------------------------------------------------------------------------
-	void setVec4(const std::string &name, const glm::vec4 &value) const
+	void setVec4(const char *name, const glm::vec4 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1,
-			     &value[0]);
+		glUniform4fv(glGetUniformLocation(ID, name), 1, &value[0]);
 	}
-	void setVec4(const std::string &name, float x, float y, float z,
-		     float w)
+	void setVec4(const char *name, float x, float y, float z, float w)
 	{
-		glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+		glUniform4f(glGetUniformLocation(ID, name), x, y, z, w);
 	}
 	// ------------------------------------------------------------------------
-	void setMat2(const std::string &name, const glm::mat2 &mat) const
+	void setMat2(const char *name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1,
+		glUniformMatrix2fv(glGetUniformLocation(ID, name), 1,
 				   GL_FALSE, &mat[0][0]);
 	}
 	// ------------------------------------------------------------------------
-	void setMat3(const std::string &name, const glm::mat3 &mat) const
+	void setMat3(const char *name, const glm::mat3 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1,
+		glUniformMatrix3fv(glGetUniformLocation(ID, name), 1,
 				   GL_FALSE, &mat[0][0]);
 	}
 	// ------------------------------------------------------------------------
-	void setMat4(const std::string &name, const glm::mat4 &mat) const
+	void setMat4(const char *name, const glm::mat4 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1,
+		glUniformMatrix4fv(glGetUniformLocation(ID, name), 1,
 				   GL_FALSE, &mat[0][0]);
 	}
 
       private:
-	// utility function for checking shader compilation/linking errors.
+	std::string vertexPath;
+	std::string fragmentPath;
+	std::string geometryPath;
+	ShaderDefines defines;
+	// canonical paths of all source files, see dependsOn
+	std::vector<std::string> dependencies;
+	// every stage's files, indexed by the source string numbers of its
+	// #line directives, to name them in compile errors
+	std::vector<std::string> vertexFiles;
+	std::vector<std::string> fragmentFiles;
+	std::vector<std::string> geometryFiles;
+
+	// a program handed to the driver to compile and link, its results are
+	// only looked at by finishBuild()
+	struct Build {
+		unsigned int program = 0;
+		// the compiled stages, 0 when the program came from the cache
+		unsigned int stages[3] = {0, 0, 0};
+		unsigned long long key = 0;
+		bool cached = false;
+		std::chrono::steady_clock::time_point start;
+	};
+	Build pending;
+	bool reloading = false;
+
+	// preprocesses the sources and starts compiling them into a new
+	// program, or fetches the linked program from the on-disk binary cache
+	// ------------------------------------------------------------------------
+	Build startBuild()
+	{
+		CPU_ZONE("Shader::startBuild");
+		// 1. retrieve the vertex/fragment source code from filePath,
+		// resolving includes and adding the defines
+		std::string vertexCode = preprocess(vertexPath, vertexFiles);
+		std::string fragmentCode =
+		    preprocess(fragmentPath, fragmentFiles);
+		std::string geometryCode;
+		geometryFiles.clear();
+		if (!geometryPath.empty())
+			geometryCode = preprocess(geometryPath, geometryFiles);
+		// every stage may include the same files
+		std::vector<std::string> included = vertexFiles;
+		included.insert(included.end(), fragmentFiles.begin(),
+				fragmentFiles.end());
+		included.insert(included.end(), geometryFiles.begin(),
+				geometryFiles.end());
+		dependencies.clear();
+		for (const std::string &path : included) {
+			char resolved[PATH_MAX];
+			if (realpath(path.c_str(), resolved))
+				dependencies.push_back(resolved);
+		}
+		// 2. compile shaders, or fetch the linked program from the
+		// on-disk binary cache
+		Build build;
+		build.start = std::chrono::steady_clock::now();
+		build.key =
+		    ProgramCache::key({vertexCode, fragmentCode, geometryCode});
+		build.program = glCreateProgram();
+		build.cached = ProgramCache::load(build.key, build.program);
+		if (!build.cached) {
+			// a rejected binary leaves the program unusable
+			glDeleteProgram(build.program);
+			build.program = glCreateProgram();
+			compile(build, vertexCode, fragmentCode, geometryCode);
+		}
+		return build;
+	}
+	// waits for the driver if it is still compiling, reports errors and
+	// stores a newly linked program in the cache; returns whether the
+	// program linked
+	// ------------------------------------------------------------------------
+	bool finishBuild(Build &build)
+	{
+		CPU_ZONE("Shader::finishBuild");
+		bool linked = build.cached;
+		if (!build.cached) {
+			const std::vector<std::string> *files[3] = {
+			    &vertexFiles, &fragmentFiles, &geometryFiles};
+			static const char *const types[3] = {
+			    "VERTEX", "FRAGMENT", "GEOMETRY"};
+			for (int i = 0; i < 3; i++)
+				if (build.stages[i])
+					checkCompileErrors(build.stages[i],
+							   types[i], files[i]);
+			linked = checkCompileErrors(build.program, "PROGRAM");
+			deleteStages(build);
+			if (linked)
+				ProgramCache::store(build.key, build.program);
+		}
+		double ms = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - build.start)
+				.count();
+		std::cout << "Shader " << name()
+			  << (build.cached ? ": loaded from binary cache in "
+					   : ": compiled and linked in ")
+			  << ms << " ms" << std::endl;
+		return linked;
+	}
+	// drops a build that was started but not finished
+	// ------------------------------------------------------------------------
+	static void abandonBuild(Build &build)
+	{
+		deleteStages(build);
+		glDeleteProgram(build.program);
+		build.program = 0;
+	}
+	static void deleteStages(Build &build)
+	{
+		for (unsigned int &stage : build.stages) {
+			if (stage)
+				glDeleteShader(stage);
+			stage = 0;
+		}
+	}
+	// whether the driver compiles and links in the background, queried
+	// once
+	// ------------------------------------------------------------------------
+	static bool parallelCompileSupported()
+	{
+		static const bool supported = [] {
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint i = 0; i < count; i++) {
+				const char *name = (const char *)glGetStringi(
+				    GL_EXTENSIONS, i);
+				if (!std::strcmp(name, "GL_KHR_parallel_shader_"
+						       "compile") ||
+				    !std::strcmp(name, "GL_ARB_parallel_shader_"
+						       "compile"))
+					return true;
+			}
+			return false;
+		}();
+		return supported;
+	}
+	// reads a shader file and puts the defines right after its #version
+	// line, #include "file" directives are resolved by readSource; files
+	// receives the stage's files, the first one being path
+	// ------------------------------------------------------------------------
+	std::string preprocess(const std::string &path,
+			       std::vector<std::string> &files) const
+	{
+		files.clear();
+		std::string source = readSource(path, files);
+
+		std::string header;
+		for (const auto &define : defines)
+			header += "#define " + define.first + " " +
+				  std::to_string(define.second) + "\n";
+		size_t version = source.find("#version");
+		size_t insertAt = 0;
+		if (version != std::string::npos)
+			insertAt = source.find('\n', version) + 1;
+		// the lines after the defines keep their numbers in path
+		if (!header.empty())
+			header += "#line " +
+				  std::to_string(std::count(source.begin(),
+							    source.begin() +
+								insertAt,
+							    '\n') +
+						 1) +
+				  " 0\n";
+		return source.insert(insertAt, header);
+	}
+	// returns the contents of a shader file with every #include "file"
+	// (relative to the including file) replaced by that file's contents,
+	// a file that was already included is skipped. #line directives
+	// around every include keep compile errors pointing at the right line,
+	// with the file's index in included as the source string number.
 	// ------------------------------------------------------------------------
-	void checkCompileErrors(GLuint shader, std::string type)
+	static std::string readSource(const std::string &path,
+				      std::vector<std::string> &included)
+	{
+		std::string index = std::to_string(included.size());
+		included.push_back(path);
+		std::string contents;
+		std::ifstream file;
+		// ensure ifstream objects can throw exceptions:
+		file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+		try {
+			file.open(path);
+			std::stringstream stream;
+			stream << file.rdbuf();
+			file.close();
+			contents = stream.str();
+		} catch (std::ifstream::failure &e) {
+			std::cout
+			    << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: "
+			    << path << std::endl;
+			return contents;
+		}
+
+		std::string directory =
+		    path.substr(0, path.find_last_of('/') + 1);
+		std::istringstream lines(contents);
+		std::string result;
+		std::string line;
+		int number = 0;
+		while (std::getline(lines, line)) {
+			number++;
+			size_t start = line.find_first_not_of(" \t");
+			if (start == std::string::npos ||
+			    line.compare(start, 8, "#include") != 0) {
+				result += line + '\n';
+				continue;
+			}
+			size_t open = line.find('"', start);
+			size_t close = line.find('"', open + 1);
+			if (open == std::string::npos ||
+			    close == std::string::npos) {
+				std::cout
+				    << "ERROR::SHADER::MALFORMED_INCLUDE: "
+				    << path << ": " << line << std::endl;
+				continue;
+			}
+			std::string includePath =
+			    directory + line.substr(open + 1, close - open - 1);
+			if (std::find(included.begin(), included.end(),
+				      includePath) == included.end()) {
+				result += "#line 1 " +
+					  std::to_string(included.size()) +
+					  "\n";
+				result += readSource(includePath, included);
+			}
+			result += "#line " + std::to_string(number + 1) + " " +
+				  index + "\n";
+		}
+		return result;
+	}
+	// hands the given sources to the driver to compile and link into the
+	// build's program, without waiting for the results
+	// ------------------------------------------------------------------------
+	static void compile(Build &build, const std::string &vertexCode,
+			    const std::string &fragmentCode,
+			    const std::string &geometryCode)
+	{
+		const std::string *codes[3] = {&vertexCode, &fragmentCode,
+					       &geometryCode};
+		static const GLenum types[3] = {
+		    GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER};
+		for (int i = 0; i < 3; i++) {
+			// the geometry shader is optional
+			if (codes[i]->empty())
+				continue;
+			const char *code = codes[i]->c_str();
+			build.stages[i] = glCreateShader(types[i]);
+			glShaderSource(build.stages[i], 1, &code, NULL);
+			glCompileShader(build.stages[i]);
+			glAttachShader(build.program, build.stages[i]);
+		}
+		ProgramCache::markRetrievable(build.program);
+		glLinkProgram(build.program);
+	}
+	// utility function for checking shader compilation/linking errors,
+	// files names the source string numbers in a stage's errors
+	// ------------------------------------------------------------------------
+	bool checkCompileErrors(GLuint shader, std::string type,
+				const std::vector<std::string> *files = nullptr)
 	{
 		GLint success;
 		GLchar infoLog[1024];
@@ -187,8 +444,14 @@ class Shader
 				std::cout << "ERROR::SHADER_COMPILATION_ERROR "
 					     "of type: "
 					  << type << "\n"
-					  << infoLog
-					  << "\n -- "
+					  << infoLog;
+				if (files)
+					for (size_t i = 0; i < files->size();
+					     i++)
+						std::cout << "source " << i
+							  << ": " << (*files)[i]
+							  << "\n";
+				std::cout << "\n -- "
 					     "---------------------------------"
 					     "------------------ -- "
 					  << std::endl;
@@ -208,6 +471,113 @@ class Shader
 				    << std::endl;
 			}
 		}
+		return success;
+	}
+	// sets every uniform of to that also exists in from to the value it
+	// has in from, leaves to as the current program
+	// ------------------------------------------------------------------------
+	static void copyUniforms(unsigned int from, unsigned int to)
+	{
+		GLint count = 0;
+		glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &count);
+		glUseProgram(to);
+		for (GLint i = 0; i < count; i++) {
+			GLchar name[256];
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(from, i, sizeof(name), NULL, &size,
+					   &type, name);
+			// arrays are reported once as "name[0]"
+			std::string base = name;
+			base = base.substr(0, base.find('['));
+			for (GLint element = 0; element < size; element++) {
+				std::string uniform =
+				    size > 1 ? base + "[" +
+						   std::to_string(element) + "]"
+					     : std::string(name);
+				GLint src =
+				    glGetUniformLocation(from, uniform.c_str());
+				GLint dst =
+				    glGetUniformLocation(to, uniform.c_str());
+				if (src != -1 && dst != -1)
+					copyUniform(from, src, dst, type);
+			}
+		}
+	}
+	// ------------------------------------------------------------------------
+	static void copyUniform(unsigned int from, GLint src, GLint dst,
+				GLenum type)
+	{
+		GLfloat f[16];
+		GLint v[4];
+		GLuint u[4];
+		switch (type) {
+		case GL_FLOAT:
+			glGetUniformfv(from, src, f);
+			glUniform1fv(dst, 1, f);
+			break;
+		case GL_FLOAT_VEC2:
+			glGetUniformfv(from, src, f);
+			glUniform2fv(dst, 1, f);
+			break;
+		case GL_FLOAT_VEC3:
+			glGetUniformfv(from, src, f);
+			glUniform3fv(dst, 1, f);
+			break;
+		case GL_FLOAT_VEC4:
+			glGetUniformfv(from, src, f);
+			glUniform4fv(dst, 1, f);
+			break;
+		case GL_FLOAT_MAT2:
+			glGetUniformfv(from, src, f);
+			glUniformMatrix2fv(dst, 1, GL_FALSE, f);
+			break;
+		case GL_FLOAT_MAT3:
+			glGetUniformfv(from, src, f);
+			glUniformMatrix3fv(dst, 1, GL_FALSE, f);
+			break;
+		case GL_FLOAT_MAT4:
+			glGetUniformfv(from, src, f);
+			glUniformMatrix4fv(dst, 1, GL_FALSE, f);
+			break;
+		// booleans are set like ints
+		case GL_INT_VEC2:
+		case GL_BOOL_VEC2:
+			glGetUniformiv(from, src, v);
+			glUniform2iv(dst, 1, v);
+			break;
+		case GL_INT_VEC3:
+		case GL_BOOL_VEC3:
+			glGetUniformiv(from, src, v);
+			glUniform3iv(dst, 1, v);
+			break;
+		case GL_INT_VEC4:
+		case GL_BOOL_VEC4:
+			glGetUniformiv(from, src, v);
+			glUniform4iv(dst, 1, v);
+			break;
+		case GL_UNSIGNED_INT:
+			glGetUniformuiv(from, src, u);
+			glUniform1uiv(dst, 1, u);
+			break;
+		case GL_UNSIGNED_INT_VEC2:
+			glGetUniformuiv(from, src, u);
+			glUniform2uiv(dst, 1, u);
+			break;
+		case GL_UNSIGNED_INT_VEC3:
+			glGetUniformuiv(from, src, u);
+			glUniform3uiv(dst, 1, u);
+			break;
+		case GL_UNSIGNED_INT_VEC4:
+			glGetUniformuiv(from, src, u);
+			glUniform4uiv(dst, 1, u);
+			break;
+		default:
+			// int, bool and the sampler units
+			glGetUniformiv(from, src, v);
+			glUniform1iv(dst, 1, v);
+			break;
+		}
 	}
 };
 #endif
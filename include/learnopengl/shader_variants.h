@@ -0,0 +1,157 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A family of Shader permutations built from the same sources. Every switch
+// becomes a #define, so a draw can pick the variant that compiles out the work
+// it doesn't need instead of branching in one uber-shader. Variants are
+// compiled the first time they're asked for and kept afterwards.
+class ShaderVariants
+{
+      public:
+	static const size_t MAX_SWITCHES = 8;
+
+	ShaderVariants(const char *vertexPath, const char *fragmentPath,
+		       const char *geometryPath = nullptr)
+	    : vertexPath(vertexPath), fragmentPath(fragmentPath),
+	      geometryPath(geometryPath ? geometryPath : "")
+	{
+	}
+
+	// declares the next permutation switch, it takes values in
+	// [0, maxValue] (booleans by default)
+	void addSwitch(const std::string &name, int maxValue = 1)
+	{
+		addSwitch(name, 0, maxValue);
+	}
+
+	// a switch taking values in [minValue, maxValue], for a #define that
+	// isn't valid below minValue (like an array size)
+	void addSwitch(const std::string &name, int minValue, int maxValue)
+	{
+		if (switches.size() == MAX_SWITCHES) {
+			std::cout << "ERROR::SHADER_VARIANTS::TOO_MANY_"
+				     "SWITCHES: "
+				  << name << " of " << fragmentPath
+				  << std::endl;
+			return;
+		}
+		switches.push_back({name, minValue, maxValue});
+	}
+
+	// sampler units (or other int uniforms) every variant is set up with
+	void setSampler(const std::string &name, int unit)
+	{
+		samplers.push_back(std::make_pair(name, unit));
+		for (auto &variant : variants) {
+			variant.second.use();
+			variant.second.setInt(name.c_str(), unit);
+		}
+	}
+
+	// returns the variant for the given switch values (in the order the
+	// switches were added), compiling it on first use. A value for every
+	// switch is expected: missing ones are taken as the switch's minimum,
+	// extra ones are ignored and values out of range are clamped, all of
+	// it reported once for every list of values.
+	Shader &get(std::initializer_list<int> values)
+	{
+		bool valid = values.size() == switches.size();
+		int settings[MAX_SWITCHES];
+		unsigned int key = 0;
+		for (size_t i = 0; i < switches.size(); i++) {
+			const Switch &s = switches[i];
+			int value = i < values.size() ? values.begin()[i]
+						      : s.minValue;
+			settings[i] = std::max(s.minValue,
+					       std::min(value, s.maxValue));
+			valid = valid && settings[i] == value;
+			key = key * (s.maxValue - s.minValue + 1) +
+			      (settings[i] - s.minValue);
+		}
+		if (!valid) {
+			std::vector<int> list(values);
+			if (reported.insert(list).second)
+				report(list);
+		}
+		std::map<unsigned int, Shader>::iterator it =
+		    variants.find(key);
+		if (it != variants.end())
+			return it->second;
+
+		ShaderDefines defines;
+		for (size_t i = 0; i < switches.size(); i++)
+			defines.push_back(
+			    std::make_pair(switches[i].name, settings[i]));
+		Shader &shader =
+		    variants
+			.insert(std::make_pair(
+			    key, Shader(vertexPath.c_str(),
+					fragmentPath.c_str(),
+					geometryPath.empty()
+					    ? nullptr
+					    : geometryPath.c_str(),
+					defines)))
+			.first->second;
+		shader.use();
+		for (const auto &sampler : samplers)
+			shader.setInt(sampler.first.c_str(), sampler.second);
+		return shader;
+	}
+
+	size_t compiledCount() const { return variants.size(); }
+
+	// appends the compiled variants that use the file at the canonical
+	// path, for rebuilding them
+	void dependents(const std::string &path, std::vector<Shader *> &shaders)
+	{
+		for (auto &variant : variants)
+			if (variant.second.dependsOn(path))
+				shaders.push_back(&variant.second);
+	}
+
+      private:
+	struct Switch {
+		std::string name;
+		int minValue;
+		int maxValue;
+	};
+
+	std::string vertexPath;
+	std::string fragmentPath;
+	std::string geometryPath;
+	std::vector<Switch> switches;
+	std::vector<std::pair<std::string, int>> samplers;
+	std::map<unsigned int, Shader> variants;
+	// value lists get() has reported, it runs every frame
+	std::set<std::vector<int>> reported;
+
+	void report(const std::vector<int> &values) const
+	{
+		if (values.size() != switches.size())
+			std::cout << "ERROR::SHADER_VARIANTS::SWITCH_COUNT: "
+				  << values.size() << " values for "
+				  << switches.size() << " switches of "
+				  << fragmentPath << std::endl;
+		for (size_t i = 0; i < switches.size() && i < values.size();
+		     i++) {
+			const Switch &s = switches[i];
+			if (values[i] < s.minValue || values[i] > s.maxValue)
+				std::cout << "ERROR::SHADER_VARIANTS::VALUE: "
+					  << s.name << "=" << values[i]
+					  << " out of [" << s.minValue << ", "
+					  << s.maxValue << "]" << std::endl;
+		}
+	}
+};
+#endif
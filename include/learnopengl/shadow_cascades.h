@@ -0,0 +1,288 @@
+#ifndef SHADOW_CASCADES_H
+#define SHADOW_CASCADES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Cascaded shadow maps for a directional light. The view frustum up to a
+// distance is split into cascades, between logarithmic and uniform splits
+// by splitLambda (1 is fully logarithmic). Each cascade is an orthographic
+// projection around a sphere centered on the camera, large enough to hold
+// its slice of the frustum whichever way the camera faces, so it doesn't
+// change as the camera turns, and it only moves in steps of a fraction of
+// its size as the camera moves.
+//
+// Every cascade keeps two depth layers: one with the static casters, and
+// the map the shaders sample, a copy of it with the dynamic casters drawn
+// on top every frame. The static layer is only redrawn when its projection
+// changed (the camera moved past the step, or the light, the splits or the
+// static bounds changed) or invalidate() was called:
+//
+//     shadows.update(view, ...);
+//     shadows.beginPass();
+//     for (int i = 0; i < shadows.count(); i++) {
+//             if (shadows.beginStatic(i))
+//                     draw the static casters with lightSpace(i)
+//             shadows.beginDynamic(i);
+//             draw the dynamic casters with lightSpace(i)
+//     }
+//     shadows.endPass();
+class ShadowCascades
+{
+      public:
+	static const int MAX_CASCADES = 4;
+
+	ShadowCascades() = default;
+	ShadowCascades(const ShadowCascades &) = delete;
+	ShadowCascades &operator=(const ShadowCascades &) = delete;
+
+	// (re)creates the maps, nothing happens while count and resolution
+	// stay the same
+	void configure(int count, int resolution)
+	{
+		if (count > MAX_CASCADES)
+			count = MAX_CASCADES;
+		count = std::max(1, count);
+		if (count == cascades && resolution == size)
+			return;
+		clear();
+		cascades = count;
+		size = resolution;
+		glGenTextures(2, textures);
+		for (unsigned int texture : textures) {
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0,
+				     GL_DEPTH_COMPONENT24, size, size,
+				     cascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT,
+				     nullptr);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+					GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+					GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		glGenFramebuffers(cascades, staticFBOs);
+		glGenFramebuffers(cascades, mapFBOs);
+		for (int i = 0; i < cascades; i++) {
+			attach(staticFBOs[i], textures[STATIC], i);
+			attach(mapFBOs[i], textures[MAP], i);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		invalidate();
+	}
+
+	// deletes the maps, must be called while the context is current
+	void clear()
+	{
+		if (cascades == 0)
+			return;
+		glDeleteFramebuffers(cascades, staticFBOs);
+		glDeleteFramebuffers(cascades, mapFBOs);
+		glDeleteTextures(2, textures);
+		cascades = 0;
+		size = 0;
+	}
+
+	// the static casters changed, every static layer is redrawn
+	void invalidate()
+	{
+		for (int i = 0; i < MAX_CASCADES; i++)
+			valid[i] = false;
+	}
+
+	// fits the cascades to the view frustum from nearPlane to distance;
+	// the depth range covers the static casters' bounds, dynamic casters
+	// outside it are clamped onto the near plane
+	void update(const glm::mat4 &view, float fovY, float aspect,
+		    float nearPlane, float distance, float splitLambda,
+		    glm::vec3 lightDirection, glm::vec3 boundsMin,
+		    glm::vec3 boundsMax)
+	{
+		// a zero direction (dragged there in the UI) lights from above
+		glm::vec3 direction =
+		    glm::length(lightDirection) > 1e-4f
+			? glm::normalize(lightDirection)
+			: glm::vec3(0.0f, -1.0f, 0.0f);
+		glm::vec3 up = std::abs(direction.y) > 0.99f
+				   ? glm::vec3(0.0f, 0.0f, 1.0f)
+				   : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 lightView =
+		    glm::lookAt(glm::vec3(0.0f), direction, up);
+		float zMin = INFINITY, zMax = -INFINITY;
+		for (int corner = 0; corner < 8; corner++) {
+			glm::vec3 p(corner & 1 ? boundsMax.x : boundsMin.x,
+				    corner & 2 ? boundsMax.y : boundsMin.y,
+				    corner & 4 ? boundsMax.z : boundsMin.z);
+			float z = (lightView * glm::vec4(p, 1.0f)).z;
+			zMin = std::min(zMin, z);
+			zMax = std::max(zMax, z);
+		}
+
+		glm::mat4 cameraToWorld = glm::inverse(view);
+		// the slice's corners are k times their depth off the axis
+		float tanHalf = std::tan(fovY * 0.5f);
+		float k2 = tanHalf * tanHalf * (1.0f + aspect * aspect);
+		for (int i = 0; i < cascades; i++) {
+			float t = (float)(i + 1) / cascades;
+			float uniform = nearPlane + (distance - nearPlane) * t;
+			float logarithmic =
+			    nearPlane * std::pow(distance / nearPlane, t);
+			float end = splitLambda * logarithmic +
+				    (1.0f - splitLambda) * uniform;
+
+			// around the camera out to the slice's far corners,
+			// which covers the slice in every orientation
+			float radius = end * std::sqrt(1.0f + k2);
+			glm::vec3 sphere = glm::vec3(cameraToWorld[3]);
+
+			// the projection stays put while the sphere is within
+			// its margin, and moves by whole texels
+			float half = radius * (1.0f + CACHE_MARGIN);
+			float texel = 2.0f * half / size;
+			float step =
+			    std::max(1.0f, std::floor(radius * CACHE_MARGIN /
+						      texel)) *
+			    texel;
+			glm::vec3 c =
+			    glm::vec3(lightView * glm::vec4(sphere, 1.0f));
+			c.x = std::floor(c.x / step + 0.5f) * step;
+			c.y = std::floor(c.y / step + 0.5f) * step;
+			glm::mat4 projection = glm::ortho(
+			    c.x - half, c.x + half, c.y - half, c.y + half,
+			    -zMax - DEPTH_PADDING, -zMin + DEPTH_PADDING);
+			glm::mat4 matrix = projection * lightView;
+			if (matrix != lightSpaces[i])
+				valid[i] = false;
+			lightSpaces[i] = matrix;
+			splits[i] = end;
+			texels[i] = texel;
+		}
+	}
+
+	// state of the shadow pass: depth clamping keeps casters in front of
+	// the near plane, a slope-scaled offset keeps surfaces from shadowing
+	// themselves
+	void beginPass()
+	{
+		glEnable(GL_DEPTH_CLAMP);
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(SLOPE_OFFSET, CONSTANT_OFFSET);
+		glDisable(GL_CULL_FACE);
+		glViewport(0, 0, size, size);
+	}
+	void endPass()
+	{
+		glDisable(GL_DEPTH_CLAMP);
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glEnable(GL_CULL_FACE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	// binds the cascade's static layer if it has to be redrawn, false
+	// when the cached one is still good
+	bool beginStatic(int cascade)
+	{
+		if (valid[cascade])
+			return false;
+		glBindFramebuffer(GL_FRAMEBUFFER, staticFBOs[cascade]);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		valid[cascade] = true;
+		staticRedraws++;
+		return true;
+	}
+	// copies the static layer into the map and binds it
+	void beginDynamic(int cascade)
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFBOs[cascade]);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mapFBOs[cascade]);
+		glBlitFramebuffer(0, 0, size, size, 0, 0, size, size,
+				  GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, mapFBOs[cascade]);
+	}
+
+	// sets the uniforms of include/shadows.glsl, the maps are bound to
+	// the shadowMaps unit by the caller
+	void setUniforms(Shader &shader) const
+	{
+		static const char *const lightSpaceNames[MAX_CASCADES] = {
+		    "lightSpace[0]", "lightSpace[1]", "lightSpace[2]",
+		    "lightSpace[3]"};
+		static const char *const splitNames[MAX_CASCADES] = {
+		    "cascadeEnd[0]", "cascadeEnd[1]", "cascadeEnd[2]",
+		    "cascadeEnd[3]"};
+		static const char *const texelNames[MAX_CASCADES] = {
+		    "cascadeTexel[0]", "cascadeTexel[1]", "cascadeTexel[2]",
+		    "cascadeTexel[3]"};
+		shader.setInt("cascadeCount", cascades);
+		for (int i = 0; i < cascades; i++) {
+			shader.setMat4(lightSpaceNames[i], lightSpaces[i]);
+			shader.setFloat(splitNames[i], splits[i]);
+			shader.setFloat(texelNames[i], texels[i]);
+		}
+	}
+
+	// GPU profiler pass of each cascade
+	static const char *passName(int cascade)
+	{
+		static const char *const names[MAX_CASCADES] = {
+		    "Shadow cascade 1", "Shadow cascade 2",
+		    "Shadow cascade 3", "Shadow cascade 4"};
+		return names[cascade];
+	}
+
+	int count() const { return cascades; }
+	int resolution() const { return size; }
+	// the depth array the shaders sample
+	unsigned int texture() const { return textures[MAP]; }
+	const glm::mat4 &lightSpace(int cascade) const
+	{
+		return lightSpaces[cascade];
+	}
+	// how often a static layer was drawn, the rest came from the cache
+	unsigned long staticRedrawCount() const { return staticRedraws; }
+
+      private:
+	// room around a cascade's sphere for the camera to move in before
+	// the cascade has to move, as a fraction of the radius
+	static constexpr float CACHE_MARGIN = 0.25f;
+	// world units in front of and behind the static casters
+	static constexpr float DEPTH_PADDING = 1.0f;
+	static constexpr float SLOPE_OFFSET = 2.0f;
+	static constexpr float CONSTANT_OFFSET = 4.0f;
+	enum { STATIC, MAP };
+
+	int cascades = 0;
+	int size = 0;
+	unsigned int textures[2] = {0, 0};
+	unsigned int staticFBOs[MAX_CASCADES] = {};
+	unsigned int mapFBOs[MAX_CASCADES] = {};
+	glm::mat4 lightSpaces[MAX_CASCADES];
+	// view depth where every cascade ends
+	float splits[MAX_CASCADES] = {};
+	// world size of a texel
+	float texels[MAX_CASCADES] = {};
+	bool valid[MAX_CASCADES] = {};
+	unsigned long staticRedraws = 0;
+
+	static void attach(unsigned int fbo, unsigned int texture, int layer)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+					  texture, 0, layer);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+		    GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::SHADOW_CASCADES::FRAMEBUFFER: "
+				     "layer "
+				  << layer << " not complete" << std::endl;
+	}
+};
+#endif
@@ -0,0 +1,223 @@
+#ifndef SSAO_H
+#define SSAO_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/sampler.h>
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+// SSAO presets, ordered from cheapest to most expensive
+enum SsaoQuality {
+	SSAO_OFF,
+	SSAO_LOW,
+	SSAO_MEDIUM,
+	SSAO_HIGH,
+	SSAO_QUALITY_COUNT
+};
+
+const char *const SSAO_QUALITY_NAMES[SSAO_QUALITY_COUNT] = {
+    "Off", "Low (1/4 res, 8 samples)", "Medium (1/2 res, 16 samples)",
+    "High (1/2 res, 32 samples)"};
+
+// Screen-space ambient occlusion of the g-buffer at reduced resolution:
+//
+// 1. ssao.fs samples a hemisphere kernel around every pixel's position and
+//    writes the open fraction with the view depth it was computed at
+// 2. ssao_blur.fs blurs it horizontally, then vertically, weighting taps
+//    down across depth edges
+// 3. the lighting pass upsamples it with include/ssao.glsl, weighting the
+//    four nearest texels by how close their depth is to the pixel's
+//
+//     ssao.configure(width, height, quality);
+//     ssao.beginOcclusion(occlusionShader, view, projection, samplers);
+//     bind gPosition and gNormal, draw a quad
+//     ssao.beginBlur(blurShader, true, samplers); draw a quad
+//     ssao.beginBlur(blurShader, false, samplers); draw a quad
+//     bind ssao.texture() for the lighting pass
+class Ssao
+{
+      public:
+	// the smallest and largest kernels of the presets, the range of
+	// KERNEL_SIZE in ssao.fs
+	static const int MIN_KERNEL_SIZE = 8;
+	static const int MAX_KERNEL_SIZE = 32;
+
+	Ssao() = default;
+	Ssao(const Ssao &) = delete;
+	Ssao &operator=(const Ssao &) = delete;
+
+	// (re)creates the targets for a g-buffer size, nothing happens while
+	// the size and the preset's resolution stay the same
+	void configure(int width, int height, SsaoQuality quality)
+	{
+		preset = quality;
+		int divisor = settings(quality).divisor;
+		int w = std::max(1, width / divisor);
+		int h = std::max(1, height / divisor);
+		if (quality == SSAO_OFF ||
+		    (w == targetWidth && h == targetHeight))
+			return;
+		clear();
+		targetWidth = w;
+		targetHeight = h;
+		glGenTextures(2, targets);
+		glGenFramebuffers(2, fbos);
+		for (int i = 0; i < 2; i++) {
+			glBindTexture(GL_TEXTURE_2D, targets[i]);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, w, h, 0, GL_RG,
+				     GL_FLOAT, nullptr);
+			glBindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+			glFramebufferTexture2D(GL_FRAMEBUFFER,
+					       GL_COLOR_ATTACHMENT0,
+					       GL_TEXTURE_2D, targets[i], 0);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+			    GL_FRAMEBUFFER_COMPLETE)
+				std::cout << "ERROR::SSAO::FRAMEBUFFER: target "
+					  << i << " not complete" << std::endl;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		if (kernel == 0)
+			createSamples();
+	}
+
+	// deletes the targets and samples, must be called while the context
+	// is current
+	void clear()
+	{
+		if (targetWidth != 0) {
+			glDeleteFramebuffers(2, fbos);
+			glDeleteTextures(2, targets);
+			targetWidth = targetHeight = 0;
+		}
+		if (kernel != 0) {
+			glDeleteTextures(1, &kernel);
+			glDeleteTextures(1, &noise);
+			kernel = noise = 0;
+		}
+	}
+
+	bool enabled() const { return preset != SSAO_OFF; }
+	SsaoQuality quality() const { return preset; }
+	int kernelSize() const { return settings(preset).kernelSize; }
+	int width() const { return targetWidth; }
+	int height() const { return targetHeight; }
+	// the blurred occlusion the lighting pass upsamples
+	unsigned int texture() const { return targets[0]; }
+
+	// binds the occlusion target and sets up ssao.fs; the kernel and the
+	// noise go to units 2 and 3, gPosition and gNormal are bound to 0 and
+	// 1 by the caller
+	void beginOcclusion(Shader &shader, const glm::mat4 &view,
+			    const glm::mat4 &projection, SamplerCache &samplers)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, fbos[0]);
+		glViewport(0, 0, targetWidth, targetHeight);
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_2D, kernel);
+		glBindSampler(2, samplers.get(SAMPLER_NEAREST,
+					      GL_CLAMP_TO_EDGE));
+		glActiveTexture(GL_TEXTURE3);
+		glBindTexture(GL_TEXTURE_2D, noise);
+		glBindSampler(3, samplers.get(SAMPLER_NEAREST, GL_REPEAT));
+		glActiveTexture(GL_TEXTURE0);
+		shader.use();
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		shader.setVec2("noiseScale",
+			       glm::vec2((float)targetWidth / NOISE_SIZE,
+					 (float)targetHeight / NOISE_SIZE));
+		shader.setFloat("radius", RADIUS);
+		shader.setFloat("bias", BIAS);
+	}
+
+	// binds one blur direction of ssao_blur.fs, the occlusion goes
+	// from one target to the other and back
+	void beginBlur(Shader &shader, bool horizontal,
+		       SamplerCache &samplers)
+	{
+		int from = horizontal ? 0 : 1;
+		glBindFramebuffer(GL_FRAMEBUFFER, fbos[1 - from]);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, targets[from]);
+		glBindSampler(0, samplers.get(SAMPLER_NEAREST,
+					      GL_CLAMP_TO_EDGE));
+		shader.use();
+		shader.setVec2("direction",
+			       horizontal ? glm::vec2(1.0f / targetWidth, 0.0f)
+					  : glm::vec2(0.0f,
+						      1.0f / targetHeight));
+		shader.setInt("radius", settings(preset).blurRadius);
+	}
+
+      private:
+	struct Preset {
+		int divisor;
+		int kernelSize;
+		int blurRadius;
+	};
+	static const Preset &settings(SsaoQuality quality)
+	{
+		static const Preset presets[SSAO_QUALITY_COUNT] = {
+		    {1, 0, 0}, {4, 8, 2}, {2, 16, 3}, {2, 32, 4}};
+		return presets[quality];
+	}
+	// world size of the kernel hemisphere
+	static constexpr float RADIUS = 0.5f;
+	// view depth a sample has to be behind the scene to count
+	static constexpr float BIAS = 0.025f;
+	// the rotation noise tiles every NOISE_SIZE pixels, the blur has to
+	// cover about as much to hide it
+	static const int NOISE_SIZE = 4;
+
+	SsaoQuality preset = SSAO_OFF;
+	int targetWidth = 0;
+	int targetHeight = 0;
+	unsigned int targets[2] = {0, 0};
+	unsigned int fbos[2] = {0, 0};
+	// MAX_KERNEL_SIZE x 1 hemisphere samples, NOISE_SIZE^2 rotations
+	unsigned int kernel = 0;
+	unsigned int noise = 0;
+
+	// a fixed seed keeps frames, and golden images, reproducible
+	void createSamples()
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		glm::vec3 samples[MAX_KERNEL_SIZE];
+		for (int i = 0; i < MAX_KERNEL_SIZE; i++) {
+			// one random draw per statement, the order of arguments
+			// is unspecified
+			float x = unit(random) * 2.0f - 1.0f;
+			float y = unit(random) * 2.0f - 1.0f;
+			float z = unit(random);
+			glm::vec3 sample =
+			    glm::normalize(glm::vec3(x, y, z)) * unit(random);
+			// more samples close to the center
+			float t = (float)i / MAX_KERNEL_SIZE;
+			samples[i] = sample * (0.1f + 0.9f * t * t);
+		}
+		glm::vec3 rotations[NOISE_SIZE * NOISE_SIZE];
+		for (glm::vec3 &rotation : rotations) {
+			float x = unit(random) * 2.0f - 1.0f;
+			float y = unit(random) * 2.0f - 1.0f;
+			rotation = glm::vec3(x, y, 0.0f);
+		}
+
+		glGenTextures(1, &kernel);
+		glBindTexture(GL_TEXTURE_2D, kernel);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, MAX_KERNEL_SIZE, 1, 0,
+			     GL_RGB, GL_FLOAT, samples);
+		glGenTextures(1, &noise);
+		glBindTexture(GL_TEXTURE_2D, noise);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, NOISE_SIZE,
+			     NOISE_SIZE, 0, GL_RGB, GL_FLOAT, rotations);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+};
+#endif
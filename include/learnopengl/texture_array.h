@@ -0,0 +1,236 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <stb_image.h>
+
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/job_system.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Packs several images into the layers of one GL_TEXTURE_2D_ARRAY so that
+// objects using different materials can be drawn without rebinding textures
+// in between. Every layer has the same size; images of a different size are
+// resampled to the layer size when they are added, box filtered along an
+// axis that shrinks so detail averages out instead of aliasing.
+class TextureArray
+{
+      public:
+	unsigned int ID = 0;
+	int width;
+	int height;
+
+	TextureArray(int width, int height) : width(width), height(height) {}
+
+	// decodes the image at path into the next free layer and returns the
+	// index of that layer
+	int addLayer(const char *path)
+	{
+		int layer = layerCount();
+		pixels.resize(pixels.size() + layerSize(), 0);
+		decode(path, layerData(layer));
+		return layer;
+	}
+
+	// like addLayer for several images, decoded in parallel by jobs;
+	// returns the index of the first layer
+	int addLayers(const std::vector<std::string> &paths, JobSystem &jobs)
+	{
+		CPU_ZONE("TextureArray::addLayers");
+		int first = layerCount();
+		pixels.resize(pixels.size() + paths.size() * layerSize(), 0);
+		JobCounter decoded;
+		for (size_t i = 0; i < paths.size(); i++) {
+			const char *path = paths[i].c_str();
+			unsigned char *dst = layerData(first + (int)i);
+			jobs.run([this, path, dst]() { decode(path, dst); },
+				 &decoded);
+		}
+		jobs.wait(decoded);
+		return first;
+	}
+
+	// decodes the image at path into layerSize() bytes at dst, resampled
+	// to the layer size; only reads the layer size so it may run on any
+	// thread
+	bool decode(const char *path, unsigned char *dst) const
+	{
+		CPU_ZONE("TextureArray::decode");
+		int w, h, nrComponents;
+		unsigned char *data = stbi_load(path, &w, &h, &nrComponents, 0);
+		if (!data) {
+			std::cout << "Texture failed to load at path: " << path
+				  << std::endl;
+			return false;
+		}
+		resample(data, w, h, nrComponents, dst);
+		stbi_image_free(data);
+		return true;
+	}
+
+	// replaces one layer of the uploaded texture with pixels produced by
+	// decode and rebuilds the mipmaps
+	void updateLayer(int layer, const unsigned char *data)
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width,
+				height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	// fills the next free layer with a single color, useful as a stand-in
+	// for a map a material doesn't have (e.g. black for no specular)
+	int addSolidLayer(glm::vec3 color)
+	{
+		int layer = layerCount();
+		pixels.resize(pixels.size() + layerSize());
+
+		unsigned char *dst = layerData(layer);
+		for (int i = 0; i < width * height; i++) {
+			dst[i * 4 + 0] = (unsigned char)(color.r * 255.0f);
+			dst[i * 4 + 1] = (unsigned char)(color.g * 255.0f);
+			dst[i * 4 + 2] = (unsigned char)(color.b * 255.0f);
+			dst[i * 4 + 3] = 255;
+		}
+		return layer;
+	}
+
+	int layerCount() const { return (int)(pixels.size() / layerSize()); }
+
+	// creates the GL texture from all added layers and releases the CPU
+	// copy of the pixels
+	void upload()
+	{
+		glGenTextures(1, &ID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height,
+			     layerCount(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			     pixels.data());
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		std::vector<unsigned char>().swap(pixels);
+	}
+
+	// bytes of one tightly packed RGBA8 layer
+	size_t layerSize() const { return (size_t)width * height * 4; }
+
+      private:
+	// staging memory for all layers, tightly packed RGBA8
+	std::vector<unsigned char> pixels;
+
+	unsigned char *layerData(int layer)
+	{
+		return pixels.data() + layer * layerSize();
+	}
+
+	// a source texel along one axis and how much it counts
+	struct Tap {
+		int texel;
+		float weight;
+	};
+
+	// resamples a w x h image with nrComponents channels into a width x
+	// height RGBA8 layer, one axis at a time
+	void resample(const unsigned char *src, int w, int h, int nrComponents,
+		      unsigned char *dst) const
+	{
+		std::vector<int> first;
+		std::vector<Tap> taps;
+
+		// across the rows into width x h RGBA
+		std::vector<float> rows((size_t)width * h * 4);
+		weights(w, width, first, taps);
+		for (int y = 0; y < h; y++) {
+			const unsigned char *in = src + (size_t)y * w *
+							    nrComponents;
+			float *out = &rows[(size_t)y * width * 4];
+			for (int x = 0; x < width; x++, out += 4) {
+				for (int t = first[x]; t < first[x + 1]; t++) {
+					const Tap &tap = taps[t];
+					for (int c = 0; c < 4; c++)
+						out[c] += tap.weight *
+							  channel(in, tap.texel,
+								  nrComponents,
+								  c);
+				}
+			}
+		}
+
+		// down the columns into the layer
+		weights(h, height, first, taps);
+		unsigned char *out = dst;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++, out += 4) {
+				float sum[4] = {};
+				for (int t = first[y]; t < first[y + 1]; t++) {
+					const Tap &tap = taps[t];
+					const float *in =
+					    &rows[((size_t)tap.texel * width +
+						   x) *
+						  4];
+					for (int c = 0; c < 4; c++)
+						sum[c] += tap.weight * in[c];
+				}
+				// the weights add up to 1, rounding may not
+				for (int c = 0; c < 4; c++)
+					out[c] = (unsigned char)std::min(
+					    sum[c] + 0.5f, 255.0f);
+			}
+		}
+	}
+
+	// the taps of every one of `to` texels resampled from `from`, texel i
+	// uses taps [first[i], first[i + 1]). Shrinking, a texel averages the
+	// source texels it covers, in part at its edges (a box filter);
+	// growing, it interpolates the two nearest.
+	static void weights(int from, int to, std::vector<int> &first,
+			    std::vector<Tap> &taps)
+	{
+		first.assign(1, 0);
+		taps.clear();
+		float scale = (float)from / to;
+		for (int i = 0; i < to; i++) {
+			if (scale > 1.0f) {
+				float begin = i * scale, end = begin + scale;
+				for (int t = (int)begin; t < from && t < end;
+				     t++) {
+					float covered =
+					    std::min(end, t + 1.0f) -
+					    std::max(begin, (float)t);
+					if (covered > 0.0f)
+						taps.push_back(
+						    {t, covered / scale});
+				}
+			} else {
+				float p = (i + 0.5f) * scale - 0.5f;
+				int t0 = p < 0.0f ? 0 : (int)p;
+				int t1 = t0 + 1 < from ? t0 + 1 : from - 1;
+				float f = p - t0 < 0.0f ? 0.0f : p - t0;
+				taps.push_back({t0, 1.0f - f});
+				taps.push_back({t1, f});
+			}
+			first.push_back((int)taps.size());
+		}
+	}
+
+	// channel c of texel x in a row, as RGBA
+	static float channel(const unsigned char *row, int x, int nrComponents,
+			     int c)
+	{
+		// greyscale images are spread over rgb, missing alpha is opaque
+		if (c == 3 && nrComponents != 2 && nrComponents != 4)
+			return 255.0f;
+		int channel = c;
+		if (nrComponents <= 2)
+			channel = c == 3 ? 1 : 0;
+		return row[x * nrComponents + channel];
+	}
+};
+#endif
@@ -8,6 +8,7 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <rg/Error.h>
+#include <utility>
 #include <vector>
 struct Vertex {
 	glm::vec3 Position;
@@ -25,6 +26,7 @@ struct Texture {
 	std::string path;
 };
 
+// owns its vertex array and buffers, so it can be moved but not copied
 class Mesh
 {
       public:
@@ -32,14 +34,35 @@ class Mesh
 	std::vector<unsigned int> indices;
 	std::vector<Texture> textures;
 
-	Mesh(const std::vector<Vertex> &vs,
-	     const std::vector<unsigned int> &ind,
-	     const std::vector<Texture> &tex)
-	    : vertices(vs), indices(ind), textures(tex)
+	// pass the arrays with std::move to avoid copying them
+	Mesh(std::vector<Vertex> vs, std::vector<unsigned int> ind,
+	     std::vector<Texture> tex)
+	    : vertices(std::move(vs)), indices(std::move(ind)),
+	      textures(std::move(tex))
 	{
 		setupMesh();
 	}
 
+	Mesh(const Mesh &) = delete;
+	Mesh &operator=(const Mesh &) = delete;
+	Mesh(Mesh &&other) noexcept { take(other); }
+	Mesh &operator=(Mesh &&other) noexcept
+	{
+		if (this != &other) {
+			release();
+			take(other);
+		}
+		return *this;
+	}
+	~Mesh() { release(); }
+
+	// frees vertices and indices, the GL buffers keep their copy
+	void freeCpuCopy()
+	{
+		std::vector<Vertex>().swap(vertices);
+		std::vector<unsigned int>().swap(indices);
+	}
+
 	void Draw(Shader &shader)
 	{
 		unsigned int diffuseNr = 1;
@@ -64,27 +87,51 @@ class Mesh
 				ASSERT(false, "Unknown texture type");
 			}
 			name.append(number);
-			shader.setInt(name, i); // texture_diffuse1
+			shader.setInt(name.c_str(), i); // texture_diffuse1
 			glBindTexture(GL_TEXTURE_2D, textures[i].id);
 		}
 
 		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT,
-			       0);
+		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
 
 		glBindVertexArray(0);
 		glActiveTexture(GL_TEXTURE0);
 	}
 
       private:
-	unsigned int VAO;
-	void setupMesh()
+	unsigned int VAO = 0;
+	unsigned int VBO = 0;
+	unsigned int EBO = 0;
+	unsigned int indexCount = 0;
+
+	void take(Mesh &other)
 	{
+		vertices = std::move(other.vertices);
+		indices = std::move(other.indices);
+		textures = std::move(other.textures);
+		VAO = other.VAO;
+		VBO = other.VBO;
+		EBO = other.EBO;
+		indexCount = other.indexCount;
+		other.VAO = other.VBO = other.EBO = 0;
+	}
 
-		unsigned int VBO;
-		unsigned int EBO;
+	void release()
+	{
+		if (VAO)
+			glDeleteVertexArrays(1, &VAO);
+		if (VBO)
+			glDeleteBuffers(1, &VBO);
+		if (EBO)
+			glDeleteBuffers(1, &EBO);
+		VAO = VBO = EBO = 0;
+	}
+
+	void setupMesh()
+	{
+		indexCount = indices.size();
 
-		glGenVertexArray(1, &VAO);
+		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
 		glGenBuffers(1, &EBO);
 
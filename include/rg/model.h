@@ -14,6 +14,10 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <rg/Error.h>
+
+unsigned int TextureFromFile(const char *filename, std::string directory);
+
+// owns its meshes and textures, so it can be moved but not copied
 class Model
 {
       public:
@@ -21,7 +25,37 @@ class Model
 	std::vector<Texture> loaded_textures;
 
 	std::string directory;
-	Model(std::string path) { loadModel(path); }
+	// without keepCpuCopy the meshes free their vertices and indices once
+	// they're uploaded
+	Model(std::string path, bool keepCpuCopy = true)
+	{
+		loadModel(path);
+		if (!keepCpuCopy)
+			for (Mesh &mesh : meshes)
+				mesh.freeCpuCopy();
+	}
+
+	Model(const Model &) = delete;
+	Model &operator=(const Model &) = delete;
+	Model(Model &&other) noexcept { take(other); }
+	Model &operator=(Model &&other) noexcept
+	{
+		if (this != &other) {
+			clear();
+			take(other);
+		}
+		return *this;
+	}
+	~Model() { clear(); }
+
+	// deletes the meshes and textures while the context is still current
+	void clear()
+	{
+		meshes.clear();
+		for (const Texture &texture : loaded_textures)
+			glDeleteTextures(1, &texture.id);
+		loaded_textures.clear();
+	}
 
 	void Draw(Shader &shader)
 	{
@@ -31,6 +65,15 @@ class Model
 	}
 
       private:
+	void take(Model &other)
+	{
+		meshes = std::move(other.meshes);
+		loaded_textures = std::move(other.loaded_textures);
+		directory = std::move(other.directory);
+		other.meshes.clear();
+		other.loaded_textures.clear();
+	}
+
 	void loadModel(std::string path)
 	{
 		Assimp::Importer importer;
@@ -51,6 +94,7 @@ class Model
 	{
 		for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
 			aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
+			// moved in, Mesh can't be copied
 			meshes.push_back(processMesh(mesh, scene));
 		}
 
@@ -65,6 +109,7 @@ class Model
 		std::vector<unsigned int> indices;
 		std::vector<Texture> textures;
 
+		vertices.reserve(mesh->mNumVertices);
 		for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
 			Vertex vertex;
 			vertex.Position.x = mesh->mVertices[i].x;
@@ -97,7 +142,7 @@ class Model
 			vertices.push_back(vertex);
 		}
 
-		for (unsigned int i = 0; i < mesh->mFaces; ++i) {
+		for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
 			aiFace face = mesh->mFaces[i];
 
 			for (unsigned int j = 0; j < face.mNumIndices; ++j) {
@@ -119,7 +164,8 @@ class Model
 		loadTextureMaterial(material, aiTextureType_HEIGHT,
 				    "texture_height", textures);
 
-		return Mesh(vertices, indices, textures);
+		return Mesh(std::move(vertices), std::move(indices),
+			    std::move(textures));
 	}
 
 	void loadTextureMaterial(aiMaterial *mat, aiTextureType type,
@@ -185,7 +231,7 @@ unsigned int TextureFromFile(const char *filename, std::string directory)
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
 				GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_FILTER,
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
 				GL_LINEAR);
 
 	} else {
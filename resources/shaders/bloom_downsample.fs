@@ -0,0 +1,66 @@
+#version 330 core
+// one step down the bloom chain: a 13-tap filter of the mip above, or the
+// scene for the first mip
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D source;
+// one texel of source
+uniform vec2 texelSize;
+// reading the scene, where a single bright pixel would flicker in the bloom
+uniform bool firstMip;
+
+// a box average weighted down by brightness (Karis average)
+vec3 KarisAverage(vec3 a, vec3 b, vec3 c, vec3 d)
+{
+    vec4 w = 1.0 / (1.0 + vec4(dot(a, vec3(0.2126, 0.7152, 0.0722)),
+                               dot(b, vec3(0.2126, 0.7152, 0.0722)),
+                               dot(c, vec3(0.2126, 0.7152, 0.0722)),
+                               dot(d, vec3(0.2126, 0.7152, 0.0722))));
+    return (a * w.x + b * w.y + c * w.z + d * w.w) / (w.x + w.y + w.z + w.w);
+}
+
+void main()
+{
+    // a b c
+    //  j k
+    // d e f
+    //  l m
+    // g h i
+    vec2 t = texelSize;
+    vec3 a = texture(source, TexCoords + vec2(-2.0, 2.0) * t).rgb;
+    vec3 b = texture(source, TexCoords + vec2(0.0, 2.0) * t).rgb;
+    vec3 c = texture(source, TexCoords + vec2(2.0, 2.0) * t).rgb;
+    vec3 d = texture(source, TexCoords + vec2(-2.0, 0.0) * t).rgb;
+    vec3 e = texture(source, TexCoords).rgb;
+    vec3 f = texture(source, TexCoords + vec2(2.0, 0.0) * t).rgb;
+    vec3 g = texture(source, TexCoords + vec2(-2.0, -2.0) * t).rgb;
+    vec3 h = texture(source, TexCoords + vec2(0.0, -2.0) * t).rgb;
+    vec3 i = texture(source, TexCoords + vec2(2.0, -2.0) * t).rgb;
+    vec3 j = texture(source, TexCoords + vec2(-1.0, 1.0) * t).rgb;
+    vec3 k = texture(source, TexCoords + vec2(1.0, 1.0) * t).rgb;
+    vec3 l = texture(source, TexCoords + vec2(-1.0, -1.0) * t).rgb;
+    vec3 m = texture(source, TexCoords + vec2(1.0, -1.0) * t).rgb;
+
+    // five overlapping boxes, the center one counting half
+    if (firstMip)
+    {
+        FragColor = KarisAverage(j, k, l, m) * 0.5 +
+                    KarisAverage(a, b, d, e) * 0.125 +
+                    KarisAverage(b, c, e, f) * 0.125 +
+                    KarisAverage(d, e, g, h) * 0.125 +
+                    KarisAverage(e, f, h, i) * 0.125;
+        // a NaN or infinity from the lighting would spread over the
+        // whole bloom, it is dropped before the chain reads it
+        if (any(isnan(FragColor)) || any(isinf(FragColor)))
+            FragColor = vec3(0.0);
+    }
+    else
+    {
+        FragColor = e * 0.125 +
+                    (a + c + g + i) * 0.03125 +
+                    (b + d + f + h) * 0.0625 +
+                    (j + k + l + m) * 0.125;
+    }
+}
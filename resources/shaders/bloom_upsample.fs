@@ -0,0 +1,27 @@
+#version 330 core
+// one step up the bloom chain: a 3x3 tent filter of the mip below, added to
+// the mip it is drawn into by blending
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D source;
+// size of the tent in texture coordinates
+uniform float filterRadius;
+
+void main()
+{
+    float x = filterRadius;
+    float y = filterRadius;
+    vec3 a = texture(source, TexCoords + vec2(-x, y)).rgb;
+    vec3 b = texture(source, TexCoords + vec2(0.0, y)).rgb;
+    vec3 c = texture(source, TexCoords + vec2(x, y)).rgb;
+    vec3 d = texture(source, TexCoords + vec2(-x, 0.0)).rgb;
+    vec3 e = texture(source, TexCoords).rgb;
+    vec3 f = texture(source, TexCoords + vec2(x, 0.0)).rgb;
+    vec3 g = texture(source, TexCoords + vec2(-x, -y)).rgb;
+    vec3 h = texture(source, TexCoords + vec2(0.0, -y)).rgb;
+    vec3 i = texture(source, TexCoords + vec2(x, -y)).rgb;
+
+    FragColor = (e * 4.0 + (b + d + f + h) * 2.0 + (a + c + g + i)) / 16.0;
+}
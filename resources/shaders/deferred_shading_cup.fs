@@ -1,4 +1,17 @@
 #version 330 core
+// number of point lights, set by the Shader loader
+#ifndef NR_LIGHTS
+#define NR_LIGHTS 1
+#endif
+// lights[0] casts shadows from its cube map
+#ifndef POINT_SHADOWS
+#define POINT_SHADOWS 1
+#endif
+// the ambient term is occluded by SSAO
+#ifndef SSAO
+#define SSAO 1
+#endif
+
 out vec4 FragColor;
 
 in vec2 TexCoords;
@@ -14,10 +27,17 @@ struct Light {
     float Linear;
     float Quadratic;
 };
-const int NR_LIGHTS = 1;
 uniform Light lights[NR_LIGHTS];
 uniform vec3 viewPos;
 
+#if POINT_SHADOWS
+#include "include/point_shadows.glsl"
+#endif
+#if SSAO
+#include "include/ssao.glsl"
+uniform mat4 view;
+#endif
+
 void main()
 {
     // retrieve data from gbuffer
@@ -27,8 +47,18 @@ void main()
     float Specular = texture(gAlbedoSpec, TexCoords).a;
 
     // then calculate lighting as usual
-    vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
+#if SSAO
+    float ambientOcclusion = SsaoOcclusion(TexCoords, -(view * vec4(FragPos, 1.0)).z);
+#else
+    float ambientOcclusion = 1.0;
+#endif
+    vec3 lighting  = Diffuse * 0.1 * ambientOcclusion; // hard-coded ambient component
     vec3 viewDir  = normalize(viewPos - FragPos);
+#if POINT_SHADOWS
+    float shadow = PointLightShadow(FragPos, Normal, lights[0].Position);
+#else
+    float shadow = 1.0;
+#endif
     for(int i = 0; i < NR_LIGHTS; ++i)
     {
         // diffuse
@@ -43,7 +73,7 @@ void main()
         float attenuation = 1.0 / (1.0 + lights[i].Linear * distance + lights[i].Quadratic * distance * distance);
         diffuse *= attenuation;
         specular *= attenuation;
-        lighting += diffuse + specular;
+        lighting += (i == 0 ? shadow : 1.0) * (diffuse + specular);
     }
     FragColor = vec4(lighting, 1.0);
 }
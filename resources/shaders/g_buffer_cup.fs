@@ -1,5 +1,5 @@
 #version 330 core
-layout (location = 0) out vec3 gPosition;
+layout (location = 0) out vec4 gPosition;
 layout (location = 1) out vec3 gNormal;
 layout (location = 2) out vec4 gAlbedoSpec;
 
@@ -12,8 +12,9 @@ uniform sampler2D texture_specular1;
 
 void main()
 {
-    // store the fragment position vector in the first gbuffer texture
-    gPosition = FragPos;
+    // store the fragment position vector in the first gbuffer texture, the
+    // alpha marks what was drawn
+    gPosition = vec4(FragPos, 1.0);
     // also store the per-fragment normals into the gbuffer
     gNormal = normalize(Normal);
     // and the diffuse per-fragment color
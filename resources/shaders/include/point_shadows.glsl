@@ -0,0 +1,33 @@
+// Cube map shadow of a point light, see include/learnopengl/point_shadows.h
+// for how it is made.
+// Pulled in with #include "include/point_shadows.glsl" by the Shader loader.
+
+uniform samplerCubeShadow pointShadowMap;
+// the distance the map covers, it stores distances over it
+uniform float pointShadowRange;
+
+// 1 where the light at lightPos reaches the fragment, 0 in shadow; 3x3 taps
+// of the hardware 2x2 comparison across the direction soften the edges.
+// Fragments out of range are lit.
+float PointLightShadow(vec3 fragPos, vec3 normal, vec3 lightPos)
+{
+    float distance = length(fragPos - lightPos);
+    if (distance >= pointShadowRange)
+        return 1.0;
+
+    // a texel of a 90 degree face is about 2 * distance / size wide here;
+    // pushing the lookup out along the normal by that, more at grazing
+    // angles, keeps surfaces from shadowing themselves
+    float texel = 2.0 * distance / float(textureSize(pointShadowMap, 0).x);
+    float facing = max(dot(normal, (lightPos - fragPos) / distance), 0.0);
+    vec3 toFrag = fragPos + normal * texel * (1.5 + 2.0 * (1.0 - facing)) - lightPos;
+    float depth = length(toFrag) / pointShadowRange;
+    vec3 axis = abs(toFrag.y) < 0.9 * length(toFrag) ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 side = normalize(cross(toFrag, axis)) * texel;
+    vec3 up = normalize(cross(side, toFrag)) * texel;
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(pointShadowMap, vec4(toFrag + side * x + up * y, depth));
+    return lit / 9.0;
+}
@@ -0,0 +1,38 @@
+// Cascaded shadow maps of the directional light, see
+// include/learnopengl/shadow_cascades.h for how they are made.
+// Pulled in with #include "include/shadows.glsl" by the Shader loader.
+
+#define MAX_CASCADES 4
+
+uniform sampler2DArrayShadow shadowMaps;
+uniform mat4 lightSpace[MAX_CASCADES];
+// view depth where each cascade ends
+uniform float cascadeEnd[MAX_CASCADES];
+// world size of a shadow map texel in each cascade
+uniform float cascadeTexel[MAX_CASCADES];
+uniform int cascadeCount;
+
+// 1 where the light reaches the fragment, 0 in shadow; 3x3 taps of the
+// hardware 2x2 comparison soften the edges. Fragments past the last
+// cascade are lit.
+float DirLightShadow(vec3 fragPos, vec3 normal, float viewDepth)
+{
+    int cascade = 0;
+    while (cascade < cascadeCount && viewDepth > cascadeEnd[cascade])
+        cascade++;
+    if (cascade == cascadeCount)
+        return 1.0;
+
+    // pushing the lookup out along the normal by about a texel keeps
+    // surfaces from shadowing themselves at grazing angles
+    vec3 offset = normal * cascadeTexel[cascade] * 1.5;
+    vec4 lightPos = lightSpace[cascade] * vec4(fragPos + offset, 1.0);
+    vec3 coords = lightPos.xyz / lightPos.w * 0.5 + 0.5;
+    vec2 texel = 1.0 / vec2(textureSize(shadowMaps, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(shadowMaps, vec4(coords.xy + vec2(x, y) * texel,
+                                            cascade, coords.z));
+    return lit / 9.0;
+}
@@ -0,0 +1,29 @@
+// Upsampling of the reduced resolution SSAO, see include/learnopengl/ssao.h
+// for how it is made.
+// Pulled in with #include "include/ssao.glsl" by the Shader loader.
+
+// occlusion and view depth from ssao_blur.fs
+uniform sampler2D ssao;
+
+// the open fraction at a full resolution pixel with view depth viewDepth:
+// the four nearest texels, weighted bilinearly and by how close their depth
+// is, so occlusion doesn't leak across the silhouettes of a smaller target
+float SsaoOcclusion(vec2 uv, float viewDepth)
+{
+    ivec2 size = textureSize(ssao, 0);
+    vec2 p = uv * vec2(size) - 0.5;
+    ivec2 base = ivec2(floor(p));
+    vec2 f = fract(p);
+    float sum = 0.0;
+    float weights = 0.0;
+    for (int y = 0; y < 2; y++)
+        for (int x = 0; x < 2; x++)
+        {
+            vec2 tap = texelFetch(ssao, clamp(base + ivec2(x, y), ivec2(0), size - 1), 0).rg;
+            float bilinear = (x == 1 ? f.x : 1.0 - f.x) * (y == 1 ? f.y : 1.0 - f.y);
+            float weight = (bilinear + 0.001) / (0.001 + abs(tap.g - viewDepth));
+            sum += tap.r * weight;
+            weights += weight;
+        }
+    return sum / weights;
+}
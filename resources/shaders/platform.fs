@@ -1,67 +1,82 @@
 #version 330 core
+// permutation switches, set by the Shader loader
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+#ifndef SHADOWS
+#define SHADOWS 1
+#endif
+#ifndef POINT_SHADOWS
+#define POINT_SHADOWS 1
+#endif
+
 out vec4 FragColor;
 
+#include "include/lights.glsl"
+#if SHADOWS
+#include "include/shadows.glsl"
+#endif
+#if POINT_SHADOWS
+#include "include/point_shadows.glsl"
+#endif
+
+// diffuse, specular and normal maps of every material live in the layers of
+// one texture array, Layers.x/y/z select the diffuse/specular/normal layer
 struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
+    sampler2DArray textures;
     float shininess;
 };
 
-struct DirLight {
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight {
-    vec3 position;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+flat in vec3 Layers;
 
 uniform vec3 viewPos;
+uniform mat4 view;
 uniform DirLight dirLight;
 uniform PointLight pointLight;
+#if SPOT_LIGHT
 uniform SpotLight spotLight;
+#endif
 uniform Material material;
 
-// function prototypes
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+#if NORMAL_MAP
+// builds a tangent frame from screen-space derivatives, so the platform
+// geometry doesn't need per-vertex tangents
+mat3 CotangentFrame(vec3 normal, vec3 position, vec2 uv)
+{
+    vec3 dp1 = dFdx(position);
+    vec3 dp2 = dFdy(position);
+    vec2 duv1 = dFdx(uv);
+    vec2 duv2 = dFdy(uv);
+
+    vec3 dp2perp = cross(dp2, normal);
+    vec3 dp1perp = cross(normal, dp1);
+    vec3 tangent = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 bitangent = dp2perp * duv1.y + dp1perp * duv2.y;
+
+    float invmax = inversesqrt(max(dot(tangent, tangent), dot(bitangent, bitangent)));
+    return mat3(tangent * invmax, bitangent * invmax, normal);
+}
+#endif
 
 void main()
 {
     // properties
     vec3 norm = normalize(Normal);
+#if NORMAL_MAP
+    vec3 mapped = texture(material.textures, vec3(TexCoords, Layers.z)).rgb * 2.0 - 1.0;
+    norm = normalize(CotangentFrame(norm, FragPos, TexCoords) * mapped);
+#endif
     vec3 viewDir = normalize(viewPos - FragPos);
+    Surface surface;
+    surface.diffuse = texture(material.textures, vec3(TexCoords, Layers.x)).rgb;
+    surface.specular = texture(material.textures, vec3(TexCoords, Layers.y)).rgb;
+    surface.shininess = material.shininess;
 
     // == =====================================================
     // Our lighting is set up in 3 phases: directional, point light and an optional flashlight
@@ -70,81 +85,25 @@ void main()
     // this fragment's final color.
     // == =====================================================
     // phase 1: directional lighting
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
+#if SHADOWS
+    // the geometric normal, normal maps don't move the shadow
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    float shadow = DirLightShadow(FragPos, normalize(Normal), viewDepth);
+#else
+    float shadow = 1.0;
+#endif
+    vec3 result = CalcDirLight(dirLight, surface, norm, viewDir, shadow);
     // phase 2: point light
-
-    result += CalcPointLight(pointLight, norm, FragPos, viewDir);
-    // phase 3: spot light
-    result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
+#if POINT_SHADOWS
+    float pointShadow = PointLightShadow(FragPos, normalize(Normal), pointLight.position);
+#else
+    float pointShadow = 1.0;
+#endif
+    result += CalcPointLight(pointLight, surface, norm, FragPos, viewDir, pointShadow);
+    // phase 3: spot light, compiled out while the flashlight is off
+#if SPOT_LIGHT
+    result += CalcSpotLight(spotLight, surface, norm, FragPos, viewDir);
+#endif
 
     FragColor = vec4(result, 1.0);
-}
-
-// calculates the color when using a directional light.
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
-{
-    vec3 lightDir = normalize(-light.direction);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
-
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
-
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
-
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-    // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction));
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+in vec3 FragPos;
+
+uniform vec3 lightPosition;
+uniform float range;
+
+// the distance to the light over its range instead of the projected depth,
+// the same in every direction
+void main()
+{
+    gl_FragDepth = length(FragPos - lightPosition) / range;
+}
@@ -0,0 +1,27 @@
+#version 330 core
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 18) out;
+
+// projection of every cube map face, and a bit for each face drawn in this
+// pass, see include/learnopengl/point_shadows.h
+uniform mat4 faceMatrices[6];
+uniform int faceMask;
+
+out vec3 FragPos;
+
+void main()
+{
+    for (int face = 0; face < 6; ++face)
+    {
+        if ((faceMask & (1 << face)) == 0)
+            continue;
+        for (int i = 0; i < 3; ++i)
+        {
+            gl_Layer = face;
+            FragPos = gl_in[i].gl_Position.xyz;
+            gl_Position = faceMatrices[face] * gl_in[i].gl_Position;
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
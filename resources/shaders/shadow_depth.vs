@@ -0,0 +1,23 @@
+#version 330 core
+// permutation switch, set by the Shader loader: per-instance model matrices
+// (the platform) instead of the model uniform
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+layout (location = 0) in vec3 aPos;
+#if INSTANCED
+layout (location = 3) in mat4 aModel;
+#else
+uniform mat4 model;
+#endif
+
+uniform mat4 lightSpace;
+
+void main()
+{
+#if INSTANCED
+    gl_Position = lightSpace * aModel * vec4(aPos, 1.0);
+#else
+    gl_Position = lightSpace * model * vec4(aPos, 1.0);
+#endif
+}
@@ -0,0 +1,62 @@
+#version 330 core
+// number of kernel samples, set by the Shader loader
+#ifndef KERNEL_SIZE
+#define KERNEL_SIZE 16
+#endif
+
+// the open fraction of the hemisphere (1 = unoccluded) and the view depth it
+// was computed at, for the depth-aware blur and upsampling
+out vec2 FragColor;
+
+in vec2 TexCoords;
+
+// world space, gPosition.a is 0 where nothing was drawn
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+// hemisphere samples in texels 0 to KERNEL_SIZE - 1, and rotations around
+// the normal tiled over the screen
+uniform sampler2D kernel;
+uniform sampler2D noise;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec2 noiseScale;
+uniform float radius;
+uniform float bias;
+
+// view depth of the empty background, far behind everything
+const float BACKGROUND_DEPTH = 10000.0;
+
+void main()
+{
+    vec4 position = texture(gPosition, TexCoords);
+    if (position.a == 0.0)
+    {
+        FragColor = vec2(1.0, BACKGROUND_DEPTH);
+        return;
+    }
+    vec3 fragPos = (view * vec4(position.xyz, 1.0)).xyz;
+    vec3 normal = normalize(mat3(view) * texture(gNormal, TexCoords).xyz);
+
+    // a tangent frame around the normal, randomly rotated per pixel
+    vec3 randomVec = texture(noise, TexCoords * noiseScale).xyz;
+    vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
+    vec3 bitangent = cross(normal, tangent);
+    mat3 TBN = mat3(tangent, bitangent, normal);
+
+    float occlusion = 0.0;
+    for (int i = 0; i < KERNEL_SIZE; ++i)
+    {
+        vec3 samplePos = fragPos + TBN * texelFetch(kernel, ivec2(i, 0), 0).xyz * radius;
+        vec4 offset = projection * vec4(samplePos, 1.0);
+        offset.xy = offset.xy / offset.w * 0.5 + 0.5;
+        vec4 scene = texture(gPosition, offset.xy);
+        if (scene.a == 0.0)
+            continue;
+        float sceneDepth = (view * vec4(scene.xyz, 1.0)).z;
+        // geometry far in front of the sample doesn't occlude it
+        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sceneDepth));
+        occlusion += (sceneDepth >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;
+    }
+    FragColor = vec2(1.0 - occlusion / float(KERNEL_SIZE), -fragPos.z);
+}
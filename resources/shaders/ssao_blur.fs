@@ -0,0 +1,34 @@
+#version 330 core
+// one direction of the separable SSAO blur, keeping the depth
+out vec2 FragColor;
+
+in vec2 TexCoords;
+
+// occlusion and view depth from ssao.fs
+uniform sampler2D occlusion;
+// one texel along the blur
+uniform vec2 direction;
+uniform int radius;
+
+// relative depth difference where a tap stops counting
+const float DEPTH_TOLERANCE = 0.05;
+
+// Gaussian taps weighted down across depth edges, so occlusion doesn't bleed
+// from one surface onto another
+void main()
+{
+    vec2 center = texture(occlusion, TexCoords).rg;
+    float sigma = float(radius) * 0.5 + 0.5;
+    float sum = 0.0;
+    float weights = 0.0;
+    for (int i = -radius; i <= radius; ++i)
+    {
+        vec2 tap = texture(occlusion, TexCoords + direction * float(i)).rg;
+        float weight = exp(-float(i * i) / (2.0 * sigma * sigma)) *
+                       max(0.0, 1.0 - abs(tap.g - center.g) / (center.g * DEPTH_TOLERANCE));
+        sum += tap.r * weight;
+        weights += weight;
+    }
+    // the center tap always counts
+    FragColor = vec2(sum / weights, center.g);
+}
@@ -0,0 +1,37 @@
+#version 330 core
+// the scene is mixed with its bloom, set by the Shader loader
+#ifndef BLOOM
+#define BLOOM 1
+#endif
+
+// the HDR scene mapped to the screen's [0, 1]
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D scene;
+uniform float exposure;
+#if BLOOM
+// the top of the bloom chain
+uniform sampler2D bloom;
+uniform float bloomStrength;
+#endif
+
+// Narkowicz's fit of the ACES filmic curve, with the fit's 0.6 scale so an
+// exposure of 1 keeps the mid tones close to where they were without
+// tonemapping; highlights roll off instead of clipping
+vec3 ACESFilm(vec3 x)
+{
+    x *= 0.6;
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14),
+                 0.0, 1.0);
+}
+
+void main()
+{
+    vec3 color = texture(scene, TexCoords).rgb;
+#if BLOOM
+    color = mix(color, texture(bloom, TexCoords).rgb, bloomStrength);
+#endif
+    FragColor = vec4(ACESFilm(color * exposure), 1.0);
+}
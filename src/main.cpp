@@ -10,12 +10,48 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// counts the heap allocations of the mesh draws
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include <learnopengl/allocation_counter.h>
+#include <learnopengl/asset_reloader.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/camera_path.h>
+#include <learnopengl/cpu_profiler.h>
 #include <learnopengl/filesystem.h>
+#include <learnopengl/frame_arena.h>
+#include <learnopengl/fixed_timestep.h>
+#include <learnopengl/flythrough_benchmark.h>
+#include <learnopengl/frame_pacer.h>
+#include <learnopengl/frame_stats.h>
+#include <learnopengl/glb_orientation_check.h>
+#include <learnopengl/golden_images.h>
+#include <learnopengl/gpu_profiler.h>
+#include <learnopengl/headless_context.h>
+#include <learnopengl/imgui_snapshot.h>
+#include <learnopengl/input_log.h>
+#include <learnopengl/job_benchmark.h>
+#include <learnopengl/job_system.h>
 #include <learnopengl/model.h>
+#include <learnopengl/model_benchmark.h>
+#include <learnopengl/obj_benchmark.h>
+#include <learnopengl/render_thread.h>
+#include <learnopengl/sampler.h>
 #include <learnopengl/shader.h>
-
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/point_shadows.h>
+#include <learnopengl/hdr_bloom.h>
+#include <learnopengl/shadow_cascades.h>
+#include <learnopengl/ssao.h>
+#include <learnopengl/texture_array.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
@@ -25,6 +61,10 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 
 void processInput(GLFWwindow *window);
 
+void moveCamera(Camera &camera, unsigned int keys, float dt);
+
+void replayEvent(GLFWwindow *window, const InputEvent &e);
+
 void key_callback(GLFWwindow *window, int key, int scancode, int action,
 		  int mods);
 
@@ -34,9 +74,9 @@ auto loadCubemap(vector<std::string> faces) -> unsigned int;
 
 void renderQuad();
 
-// settings
-const unsigned int SCR_WIDTH = 800;
-const unsigned int SCR_HEIGHT = 600;
+// settings, the resolution can be set with --width and --height
+unsigned int SCR_WIDTH = 800;
+unsigned int SCR_HEIGHT = 600;
 
 // camera
 
@@ -48,6 +88,81 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// framebuffer size, the render thread sets the viewport from it
+int viewportWidth = 0;
+int viewportHeight = 0;
+
+// frames are rendered on a thread of their own while the main thread
+// handles input and simulation, --single-thread does both on the main thread
+bool singleThread = false;
+// threads running jobs including the one waiting for them, --job-threads
+// overrides the default of one per core
+int jobThreads = 0;
+
+// movement keys held this frame, a bit per Camera_Movement
+unsigned int heldKeys = 0;
+// camera movement runs in fixed steps, --sim-rate sets how many per second
+float simulationRate = 120.0f;
+
+// CPU trace: --trace-frames N captures startup and the first N frames, F2
+// starts and stops a capture at any time
+unsigned int traceFrames = 0;
+std::string traceFile = "trace.json";
+
+// --headless renders a fixed number of frames into an offscreen framebuffer
+// through EGL instead of a window, prints frame time statistics and exits
+bool headless = false;
+// frames rendered by --headless and --benchmark runs
+unsigned int fixedFrames = 300;
+
+// --benchmark flies the camera along a path file and writes per-section
+// frame times as JSON; F3 appends the current camera pose to
+// cameraPathFile to record such a path
+std::string benchmarkPath;
+std::string benchmarkOutput = "benchmark.json";
+std::string cameraPathFile = "camera_path.txt";
+
+// --golden renders every view of a views file headlessly and compares it
+// against the reference images in goldenDir, --golden-update rewrites them
+std::string goldenViews;
+std::string goldenDir = "resources/golden";
+std::string goldenOutput = "golden_output";
+bool goldenUpdate = false;
+float goldenTolerance = 3.0f;
+
+// --record writes the session's input to a log, --replay plays one back in
+// place of live input (also with --headless, not with --benchmark or
+// --golden)
+std::string recordFile;
+std::string replayFile;
+InputLog inputLog;
+
+// fixed-length runs report the heap allocations per frame after the first
+// few, --allocation-check also lists where they come from and fails the run
+// if there are any (golden runs always do, capturing allocates)
+bool allocationCheck = false;
+const unsigned int ALLOCATION_WARMUP_FRAMES = 3;
+
+// --shadow-cascades and --shadow-resolution override the defaults of the
+// "Shadows" window, --no-shadows turns the directional light's shadows off
+int shadowCascades = 0;
+int shadowResolution = 0;
+bool noShadows = false;
+// --point-shadow-budget and --point-shadow-resolution do the same for the
+// point light's cube map shadows, --no-point-shadows turns them off
+int pointShadowBudget = 0;
+int pointShadowResolution = 0;
+bool noPointShadows = false;
+// --ssao off|low|medium|high picks the SSAO preset, -1 keeps the default
+int ssaoQuality = -1;
+// --bloom off|half|full picks the bloom resolution, -1 keeps the default
+int bloomResolution = -1;
+// --exposure scales the scene before tonemapping, 0 keeps the default
+float exposure = 0.0f;
+
+// seconds since start, glfwGetTime needs glfw which headless runs don't use
+double getTime();
+
 struct PointLight {
 	glm::vec3 position;
 	glm::vec3 ambient;
@@ -59,15 +174,44 @@ struct PointLight {
 	float quadratic;
 };
 
+// per-instance data of the platform objects (table, legs, pot and soil), all
+// of them are drawn with a single instanced call
+struct PlatformInstance {
+	glm::mat4 model;
+	// texture array layers: x = diffuse, y = specular, z = normal
+	glm::vec3 layers;
+};
+
 struct ProgramState {
 	glm::vec3 clearColor = glm::vec3(0);
 	bool ImGuiEnabled = false;
 	Camera camera;
 	bool spotLightEnabled = false;
+	bool normalMapsEnabled = true;
 	bool CameraMouseMovementUpdateEnabled = true;
 	glm::vec3 cupPosition = glm::vec3(0.0f, 0.0f, -4.0f);
 	float cupScale = 0.5f;
 	PointLight pointLight;
+	TextureQuality textureQuality = TEXTURE_QUALITY_ANISOTROPIC_4X;
+	bool gpuProfilerEnabled = true;
+	// the directional light and its cascaded shadow maps
+	glm::vec3 dirLightDirection = glm::vec3(-0.2f, -1.0f, -0.3f);
+	bool shadowsEnabled = true;
+	int shadowCascades = 3;
+	int shadowResolution = 1024;
+	float shadowSplitLambda = 0.75f;
+	float shadowDistance = 40.0f;
+	// cube map shadows of the point light, at most pointShadowBudget faces
+	// are redrawn per frame
+	bool pointShadowsEnabled = true;
+	int pointShadowResolution = 512;
+	int pointShadowBudget = 6;
+	SsaoQuality ssaoQuality = SSAO_MEDIUM;
+	// the HDR scene is scaled by exposure and tonemapped, its bloom mixed
+	// in by bloomStrength
+	BloomResolution bloomResolution = BLOOM_HALF;
+	float exposure = 1.0f;
+	float bloomStrength = 0.04f;
 	ProgramState() : camera(glm::vec3(0.0f, 0.0f, 3.0f)) {};
 
 	void SaveToFile(std::string filename);
@@ -104,78 +248,492 @@ void ProgramState::LoadFromFile(std::string filename)
 
 ProgramState *programState;
 
-void DrawImGui(ProgramState *programState);
+// everything the render thread needs to draw a frame, the main thread
+// builds one per frame
+struct RenderPacket {
+	unsigned int frame = 0;
+	double startTime = 0.0;
+	// FramePacer::inputRead of the frame
+	long long inputTime = 0;
+	// interpolated between the last two simulation steps
+	Camera camera;
+	ProgramState state;
+	int swapInterval = 1;
+	bool lowLatency = false;
+	int viewportWidth = 0;
+	int viewportHeight = 0;
+	ImGuiSnapshot imgui;
+};
+
+// what the render thread reports back for the overlay
+struct RenderStats {
+	struct Pass {
+		const char *name;
+		GpuProfiler::Stats stats;
+	};
+	std::vector<Pass> passes;
+	unsigned long droppedQueries = 0;
+	// static shadow cascades drawn so far, see ShadowCascades
+	unsigned long shadowRedraws = 0;
+	// point shadow faces drawn so far and waiting, see PointShadows
+	unsigned long pointShadowRedraws = 0;
+	int pointShadowsPending = 0;
+	float latencyAverage = 0.0f;
+	float latencyP95 = 0.0f;
+};
+
+// how the main and the render thread spent their time, in milliseconds
+struct ThreadStats {
+	RenderStats render;
+	bool threaded = false;
+	float frame = 0.0f;
+	float mainBusy = 0.0f;
+	float mainWait = 0.0f;
+	float renderBusy = 0.0f;
+	float renderWait = 0.0f;
+
+	// call once renderBusy is set
+	void add(float frameTime, float busy, float wait)
+	{
+		frame = frameTime;
+		mainBusy = busy;
+		mainWait = wait;
+		frames++;
+		frameSum += frameTime;
+		mainSum += busy;
+		renderSum += renderBusy;
+		overlapSum += overlap();
+	}
+	// share of the frame both threads were busy at once
+	float overlap() const
+	{
+		if (frame <= 0.0f)
+			return 0.0f;
+		float both = std::max(0.0f, mainBusy + renderBusy - frame);
+		return std::min(both, std::min(mainBusy, renderBusy)) / frame;
+	}
+	float averageFrame() const { return frames ? frameSum / frames : 0; }
+	float averageMainBusy() const { return frames ? mainSum / frames : 0; }
+	float averageRenderBusy() const
+	{
+		return frames ? renderSum / frames : 0;
+	}
+	float averageOverlap() const
+	{
+		return frames ? overlapSum / frames : 0;
+	}
+
+      private:
+	unsigned long frames = 0;
+	double frameSum = 0.0, mainSum = 0.0, renderSum = 0.0;
+	double overlapSum = 0.0;
+};
+
+void DrawImGui(ProgramState *programState, const ThreadStats &threadStats,
+	       const FixedTimestep &timestep, FramePacer &framePacer);
 
-auto main() -> int
+auto main(int argc, char **argv) -> int
 {
-	// glfw: initialize and configure
-	// ------------------------------
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// vsync, frame limit and low-latency mode, also set from the ImGui
+	// "Frame pacing" window
+	FramePacer framePacer;
+	bool jobBenchmark = false;
+	std::string objBenchmark;
+	std::string modelBenchmark;
+	// --glb-check loads a .glb file and checks its texture's orientation
+	std::string glbCheck;
+	for (int i = 1; i < argc; i++) {
+		// a value that isn't one of a flag's choices is reported like
+		// an unknown argument
+		bool known = true;
+		if (!std::strcmp(argv[i], "--trace-frames") && i + 1 < argc) {
+			traceFrames = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--trace-file") &&
+			   i + 1 < argc) {
+			traceFile = argv[++i];
+		} else if (!std::strcmp(argv[i], "--headless")) {
+			headless = true;
+		} else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc) {
+			fixedFrames = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--benchmark") &&
+			   i + 1 < argc) {
+			benchmarkPath = argv[++i];
+		} else if (!std::strcmp(argv[i], "--benchmark-output") &&
+			   i + 1 < argc) {
+			benchmarkOutput = argv[++i];
+		} else if (!std::strcmp(argv[i], "--golden") && i + 1 < argc) {
+			goldenViews = argv[++i];
+		} else if (!std::strcmp(argv[i], "--golden-update")) {
+			goldenUpdate = true;
+		} else if (!std::strcmp(argv[i], "--golden-dir") &&
+			   i + 1 < argc) {
+			goldenDir = argv[++i];
+		} else if (!std::strcmp(argv[i], "--golden-output") &&
+			   i + 1 < argc) {
+			goldenOutput = argv[++i];
+		} else if (!std::strcmp(argv[i], "--golden-tolerance") &&
+			   i + 1 < argc) {
+			goldenTolerance = std::atof(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--record") && i + 1 < argc) {
+			recordFile = argv[++i];
+		} else if (!std::strcmp(argv[i], "--replay") && i + 1 < argc) {
+			replayFile = argv[++i];
+		} else if (!std::strcmp(argv[i], "--sim-rate") &&
+			   i + 1 < argc) {
+			simulationRate = std::atof(argv[++i]);
+			// atof gives 0 for anything that isn't a number
+			if (!(simulationRate > 0.0f) ||
+			    !std::isfinite(simulationRate)) {
+				std::cout << "--sim-rate needs a positive "
+					     "number of steps per second, got "
+					  << argv[i] << std::endl;
+				return -1;
+			}
+		} else if (!std::strcmp(argv[i], "--vsync") && i + 1 < argc) {
+			i++;
+			if (!std::strcmp(argv[i], "off"))
+				framePacer.vsync = VSYNC_OFF;
+			else if (!std::strcmp(argv[i], "on"))
+				framePacer.vsync = VSYNC_ON;
+			else if (!std::strcmp(argv[i], "adaptive"))
+				framePacer.vsync = VSYNC_ADAPTIVE;
+			else
+				known = false;
+		} else if (!std::strcmp(argv[i], "--fps-limit") &&
+			   i + 1 < argc) {
+			framePacer.fpsLimit = std::atof(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--low-latency")) {
+			framePacer.lowLatency = true;
+		} else if (!std::strcmp(argv[i], "--single-thread")) {
+			singleThread = true;
+		} else if (!std::strcmp(argv[i], "--job-threads") &&
+			   i + 1 < argc) {
+			jobThreads = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--job-benchmark")) {
+			jobBenchmark = true;
+		} else if (!std::strcmp(argv[i], "--obj-benchmark") &&
+			   i + 1 < argc) {
+			objBenchmark = argv[++i];
+		} else if (!std::strcmp(argv[i], "--assimp-obj")) {
+			Model::nativeObj() = false;
+		} else if (!std::strcmp(argv[i], "--assimp-glb")) {
+			Model::nativeGlb() = false;
+		} else if (!std::strcmp(argv[i], "--model-benchmark") &&
+			   i + 1 < argc) {
+			modelBenchmark = argv[++i];
+			headless = true;
+		} else if (!std::strcmp(argv[i], "--glb-check") &&
+			   i + 1 < argc) {
+			glbCheck = argv[++i];
+			headless = true;
+		} else if (!std::strcmp(argv[i], "--shadow-cascades") &&
+			   i + 1 < argc) {
+			shadowCascades = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--shadow-resolution") &&
+			   i + 1 < argc) {
+			shadowResolution = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--no-shadows")) {
+			noShadows = true;
+		} else if (!std::strcmp(argv[i], "--point-shadow-budget") &&
+			   i + 1 < argc) {
+			pointShadowBudget = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i],
+					"--point-shadow-resolution") &&
+			   i + 1 < argc) {
+			pointShadowResolution = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--no-point-shadows")) {
+			noPointShadows = true;
+		} else if (!std::strcmp(argv[i], "--ssao") && i + 1 < argc) {
+			static const char *const presets[SSAO_QUALITY_COUNT] = {
+			    "off", "low", "medium", "high"};
+			i++;
+			ssaoQuality = -1;
+			for (int q = 0; q < SSAO_QUALITY_COUNT; q++)
+				if (!std::strcmp(argv[i], presets[q]))
+					ssaoQuality = q;
+			known = ssaoQuality != -1;
+		} else if (!std::strcmp(argv[i], "--bloom") && i + 1 < argc) {
+			i++;
+			if (!std::strcmp(argv[i], "off"))
+				bloomResolution = BLOOM_OFF;
+			else if (!std::strcmp(argv[i], "half"))
+				bloomResolution = BLOOM_HALF;
+			else if (!std::strcmp(argv[i], "full"))
+				bloomResolution = BLOOM_FULL;
+			else
+				known = false;
+		} else if (!std::strcmp(argv[i], "--exposure") &&
+			   i + 1 < argc) {
+			exposure = std::atof(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--allocation-check")) {
+			allocationCheck = true;
+		} else if (!std::strcmp(argv[i], "--width") && i + 1 < argc) {
+			SCR_WIDTH = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--height") && i + 1 < argc) {
+			SCR_HEIGHT = std::atoi(argv[++i]);
+		} else {
+			known = false;
+		}
+		if (!known) {
+			std::cout << "Unknown argument: " << argv[i]
+				  << std::endl;
+			std::cout << "Usage: " << argv[0]
+				  << " [--trace-frames N] [--trace-file path]"
+				     " [--headless] [--frames N] [--width W]"
+				     " [--height H] [--benchmark path]"
+				     " [--benchmark-output file]"
+				     " [--golden views] [--golden-update]"
+				     " [--golden-dir dir] [--golden-output dir]"
+				     " [--golden-tolerance dE]"
+				     " [--record log] [--replay log]"
+				     " [--sim-rate Hz]"
+				     " [--vsync off|on|adaptive]"
+				     " [--fps-limit N] [--low-latency]"
+				     " [--single-thread] [--job-threads N]"
+				     " [--job-benchmark] [--obj-benchmark obj]"
+				     " [--assimp-obj] [--assimp-glb]"
+				     " [--model-benchmark model]"
+				     " [--glb-check glb]"
+				     " [--shadow-cascades N]"
+				     " [--shadow-resolution N] [--no-shadows]"
+				     " [--point-shadow-budget N]"
+				     " [--point-shadow-resolution N]"
+				     " [--no-point-shadows]"
+				     " [--ssao off|low|medium|high]"
+				     " [--bloom off|half|full] [--exposure E]"
+				     " [--allocation-check]"
+				  << std::endl;
+			return -1;
+		}
+	}
+	if (jobBenchmark) {
+		// measures the job system alone, no context needed
+		JobBenchmark().run(jobThreads);
+		return 0;
+	}
+	if (!objBenchmark.empty())
+		return ObjBenchmark().run(objBenchmark, jobThreads) ? 0 : -1;
+	if (!replayFile.empty() &&
+	    (!benchmarkPath.empty() || !goldenViews.empty())) {
+		// both pose the camera themselves, for a different number
+		// of frames than the log holds
+		std::cout << "--replay can't be combined with --benchmark or "
+			     "--golden"
+			  << std::endl;
+		return -1;
+	}
+	FlythroughBenchmark benchmark;
+	bool benchmarking = !benchmarkPath.empty();
+	if (benchmarking && !benchmark.load(benchmarkPath, fixedFrames))
+		return -1;
+	GoldenImages goldenImages;
+	goldenImages.tolerance = goldenTolerance;
+	bool goldenTesting = !goldenViews.empty();
+	if (goldenTesting) {
+		// references come from the software renderer, never a window
+		headless = true;
+		if (!goldenImages.load(goldenViews, goldenDir, goldenOutput,
+				       goldenUpdate))
+			return -1;
+	}
+	bool replaying = !replayFile.empty();
+	if (replaying && !inputLog.loadReplay(replayFile))
+		return -1;
+	CpuProfiler::setThreadName("main");
+	// worker threads for parallel tasks such as decoding assets
+	JobSystem jobs(jobThreads - 1);
+	if (traceFrames > 0)
+		CpuProfiler::start();
+
+	GLFWwindow *window = nullptr;
+	HeadlessContext headlessContext;
+	GLADloadproc loader = (GLADloadproc)glfwGetProcAddress;
+	if (headless) {
+		if (!headlessContext.create())
+			return -1;
+		loader = HeadlessContext::loader();
+	} else {
+		// glfw: initialize and configure
+		// ------------------------------
+		glfwInit();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-	// glfw window creation
-	// --------------------
-	GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT,
-					      "LearnOpenGL", nullptr, nullptr);
-	if (window == nullptr) {
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
+		// glfw window creation
+		// --------------------
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL",
+					  nullptr, nullptr);
+		if (window == nullptr) {
+			std::cout << "Failed to create GLFW window"
+				  << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		glfwMakeContextCurrent(window);
+		glfwGetFramebufferSize(window, &viewportWidth, &viewportHeight);
+		framePacer.adaptiveSupported =
+		    glfwExtensionSupported("GLX_EXT_swap_control_tear") ||
+		    glfwExtensionSupported("WGL_EXT_swap_control_tear");
+		// benchmarks measure the renderer, not the display refresh
+		if (benchmarking)
+			framePacer.vsync = VSYNC_OFF;
+		glfwSetFramebufferSizeCallback(window,
+					       framebuffer_size_callback);
+		// a replay feeds the callbacks from the log instead
+		if (!replaying) {
+			glfwSetCursorPosCallback(window, mouse_callback);
+			glfwSetScrollCallback(window, scroll_callback);
+			glfwSetKeyCallback(window, key_callback);
+		}
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 	}
-	glfwMakeContextCurrent(window);
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-	glfwSetCursorPosCallback(window, mouse_callback);
-	glfwSetScrollCallback(window, scroll_callback);
-	glfwSetKeyCallback(window, key_callback);
-	// tell GLFW to capture our mouse
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+	if (!gladLoadGLLoader(loader)) {
 		std::cout << "Failed to initialize GLAD" << std::endl;
+		if (headless)
+			headlessContext.destroy();
+		else
+			glfwTerminate();
 		return -1;
 	}
 
+	if (goldenTesting && !GoldenImages::checkRenderer()) {
+		headlessContext.destroy();
+		return -1;
+	}
+
+	ProgramCache::init(loader);
+
 	// tell stb_image.h to flip loaded texture's on the y-axis (before
 	// loading model).
 	stbi_set_flip_vertically_on_load(true);
+	Model::imagesFlippedOnLoad() = true;
 
-	programState = new ProgramState;
-	programState->LoadFromFile("resources/program_state.txt");
-	if (programState->ImGuiEnabled) {
-		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+	if (!modelBenchmark.empty()) {
+		// uploads need the context, nothing else is set up
+		bool loaded = ModelBenchmark().run(modelBenchmark, jobs);
+		headlessContext.destroy();
+		return loaded ? 0 : -1;
+	}
+	if (!glbCheck.empty()) {
+		bool passed = GlbOrientationCheck().run(glbCheck, jobs);
+		headlessContext.destroy();
+		return passed ? 0 : -1;
 	}
-	// Init Imgui
-	IMGUI_CHECKVERSION();
-	ImGui::CreateContext();
-	ImGuiIO &io = ImGui::GetIO();
-	(void)io;
 
-	ImGui_ImplGlfw_InitForOpenGL(window, true);
-	ImGui_ImplOpenGL3_Init("#version 330 core");
+	programState = new ProgramState;
+	// benchmarks, golden images and input logs always start from the
+	// defaults so they don't depend on the last session
+	bool defaultState = benchmarking || goldenTesting ||
+			    !recordFile.empty() || replaying;
+	if (!defaultState)
+		programState->LoadFromFile("resources/program_state.txt");
+	if (shadowCascades > 0)
+		programState->shadowCascades = shadowCascades;
+	if (shadowResolution > 0)
+		programState->shadowResolution = shadowResolution;
+	if (noShadows)
+		programState->shadowsEnabled = false;
+	if (pointShadowBudget > 0)
+		programState->pointShadowBudget = pointShadowBudget;
+	if (pointShadowResolution > 0)
+		programState->pointShadowResolution = pointShadowResolution;
+	if (noPointShadows)
+		programState->pointShadowsEnabled = false;
+	if (ssaoQuality >= 0)
+		programState->ssaoQuality = (SsaoQuality)ssaoQuality;
+	if (bloomResolution >= 0)
+		programState->bloomResolution =
+		    (BloomResolution)bloomResolution;
+	if (exposure > 0.0f)
+		programState->exposure = exposure;
+	if (headless) {
+		programState->ImGuiEnabled = false;
+	} else {
+		if (programState->ImGuiEnabled) {
+			glfwSetInputMode(window, GLFW_CURSOR,
+					 GLFW_CURSOR_NORMAL);
+		}
+		// Init Imgui
+		IMGUI_CHECKVERSION();
+		ImGui::CreateContext();
+		ImGuiIO &io = ImGui::GetIO();
+		(void)io;
+
+		ImGui_ImplGlfw_InitForOpenGL(window, true);
+		ImGui_ImplOpenGL3_Init("#version 330 core");
+		// builds the font atlas ImGui::NewFrame needs, on the main
+		// thread while it still has the context
+		ImGui_ImplOpenGL3_NewFrame();
+	}
 
 	// configure global opengl state
 	// -----------------------------
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
+	// filters across cube map faces, the point shadows' PCF taps cross
+	// them
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	Shader shaderGeometryPass("resources/shaders/g_buffer_cup.vs",
 				  "resources/shaders/g_buffer_cup.fs");
-	Shader shaderLightingPass("resources/shaders/deferred_shading_cup.vs",
-				  "resources/shaders/deferred_shading_cup.fs");
+	// the lighting pass is specialized for the number of point lights and
+	// whether the first one casts shadows
+	ShaderVariants lightingPassShaders(
+	    "resources/shaders/deferred_shading_cup.vs",
+	    "resources/shaders/deferred_shading_cup.fs");
+	lightingPassShaders.addSwitch("NR_LIGHTS", 1, 4);
+	lightingPassShaders.addSwitch("POINT_SHADOWS");
+	lightingPassShaders.addSwitch("SSAO");
+	// SSAO at reduced resolution, specialized for the kernel size, and
+	// its blur; both draw the lighting pass' quad
+	ShaderVariants ssaoShaders("resources/shaders/deferred_shading_cup.vs",
+				   "resources/shaders/ssao.fs");
+	ssaoShaders.addSwitch("KERNEL_SIZE", Ssao::MIN_KERNEL_SIZE,
+			      Ssao::MAX_KERNEL_SIZE);
+	Shader ssaoBlurShader("resources/shaders/deferred_shading_cup.vs",
+			      "resources/shaders/ssao_blur.fs");
+	// the bloom chain and the tonemapping into the screen, drawing the
+	// same quad
+	Shader bloomDownsampleShader(
+	    "resources/shaders/deferred_shading_cup.vs",
+	    "resources/shaders/bloom_downsample.fs");
+	Shader bloomUpsampleShader("resources/shaders/deferred_shading_cup.vs",
+				   "resources/shaders/bloom_upsample.fs");
+	ShaderVariants tonemapShaders(
+	    "resources/shaders/deferred_shading_cup.vs",
+	    "resources/shaders/tonemap.fs");
+	tonemapShaders.addSwitch("BLOOM");
 
 	// build and compile shaders
 	// -------------------------
-	Shader platformShader("resources/shaders/platform.vs",
-			      "resources/shaders/platform.fs");
+	// platform variants compile out the flashlight while it's off, normal
+	// mapping and shadows while they're disabled
+	ShaderVariants platformShaders("resources/shaders/platform.vs",
+				       "resources/shaders/platform.fs");
+	platformShaders.addSwitch("SPOT_LIGHT");
+	platformShaders.addSwitch("NORMAL_MAP");
+	platformShaders.addSwitch("SHADOWS");
+	platformShaders.addSwitch("POINT_SHADOWS");
+	// shadow casters, the instanced variant draws the platform
+	ShaderVariants shadowShaders("resources/shaders/shadow_depth.vs",
+				     "resources/shaders/shadow_depth.fs");
+	shadowShaders.addSwitch("INSTANCED");
+	// point shadow casters, into every cube face in one pass
+	ShaderVariants pointShadowShaders(
+	    "resources/shaders/point_shadow_depth.vs",
+	    "resources/shaders/point_shadow_depth.fs",
+	    "resources/shaders/point_shadow_depth.gs");
+	pointShadowShaders.addSwitch("INSTANCED");
 	Shader grassShader("resources/shaders/grass.vs",
 			   "resources/shaders/grass.fs");
 	Shader skyboxShader("resources/shaders/skybox.vs",
@@ -303,6 +861,35 @@ auto main() -> int
 		std::cout << "Framebuffer not complete!" << std::endl;
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	// the framebuffer the frame ends up in: the window's, or without one
+	// an offscreen stand-in with the g-buffer's depth format so the depth
+	// blit below stays valid
+	unsigned int screenFBO = 0;
+	unsigned int screenColor = 0, screenDepth = 0;
+	if (headless) {
+		glGenFramebuffers(1, &screenFBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, screenFBO);
+		glGenRenderbuffers(1, &screenColor);
+		glBindRenderbuffer(GL_RENDERBUFFER, screenColor);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH,
+				      SCR_HEIGHT);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+					  GL_RENDERBUFFER, screenColor);
+		glGenRenderbuffers(1, &screenDepth);
+		glBindRenderbuffer(GL_RENDERBUFFER, screenDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT,
+				      SCR_WIDTH, SCR_HEIGHT);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+					  GL_RENDERBUFFER, screenDepth);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+		    GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "Offscreen framebuffer not complete!"
+				  << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		viewportWidth = SCR_WIDTH;
+		viewportHeight = SCR_HEIGHT;
+	}
+
 	// platform
 	unsigned int platformVAO, platformVBO, platformEBO;
 	glGenVertexArrays(1, &platformVAO);
@@ -331,6 +918,25 @@ auto main() -> int
 			      (void *)(6 * sizeof(float)));
 	glEnableVertexAttribArray(2);
 
+	// per-instance attributes, filled once the materials are loaded
+	unsigned int platformInstanceVBO;
+	glGenBuffers(1, &platformInstanceVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, platformInstanceVBO);
+	// a mat4 takes up four consecutive attribute locations
+	for (int i = 0; i < 4; i++) {
+		glEnableVertexAttribArray(3 + i);
+		glVertexAttribPointer(
+		    3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(PlatformInstance),
+		    (void *)(offsetof(PlatformInstance, model) +
+			     i * sizeof(glm::vec4)));
+		glVertexAttribDivisor(3 + i, 1);
+	}
+	glEnableVertexAttribArray(7);
+	glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE,
+			      sizeof(PlatformInstance),
+			      (void *)offsetof(PlatformInstance, layers));
+	glVertexAttribDivisor(7, 1);
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 
@@ -375,40 +981,141 @@ auto main() -> int
 	skyboxShader.use();
 	skyboxShader.setInt("skybox", 0);
 
-	platformShader.use();
-	unsigned int platformDiffuse = load2DTexture(
+	// all platform materials share one texture array so the table, legs,
+	// pot and soil can be drawn without rebinding textures
+	vector<std::string> platformTextures{
 	    FileSystem::getPath(
-		"resources/textures/Stylized_Crate_002_basecolor.jpg")
-		.c_str());
-	platformShader.setInt("material.diffuse", 0);
-	unsigned int platformSpecular = load2DTexture(
+		"resources/textures/Stylized_Crate_002_basecolor.jpg"),
 	    FileSystem::getPath(
-		"resources/textures/Stylized_Crate_002_metallic.jpg")
-		.c_str());
-	platformShader.setInt("material.specular", 1);
-	unsigned int legDiffuse = load2DTexture(
-	    FileSystem::getPath("resources/textures/toy_box_diffuse.png")
-		.c_str());
-	unsigned int land = load2DTexture(
-	    FileSystem::getPath("resources/textures/pot.png").c_str());
-	unsigned int plastic = load2DTexture(
-	    FileSystem::getPath("resources/textures/saksija.jpg").c_str());
-
-	unsigned int cupsDiffuse = load2DTexture(
-	    FileSystem::getPath("resources/objects/cup/coffee_cup.jpg")
-		.c_str());
+		"resources/textures/Stylized_Crate_002_metallic.jpg"),
+	    FileSystem::getPath("resources/textures/toy_box_diffuse.png"),
+	    FileSystem::getPath("resources/textures/pot.png"),
+	    FileSystem::getPath("resources/textures/saksija.jpg"),
+	    FileSystem::getPath(
+		"resources/textures/Stylized_Crate_002_normal.jpg")};
+	TextureArray platformMaterials(1024, 1024);
+	platformMaterials.addLayers(platformTextures, jobs);
+	int platformDiffuse = 0;
+	int platformSpecular = 1;
+	int legDiffuse = 2;
+	int land = 3;
+	int plastic = 4;
+	int platformNormal = 5;
+	int noSpecular = platformMaterials.addSolidLayer(glm::vec3(0.0f));
+	int flatNormal =
+	    platformMaterials.addSolidLayer(glm::vec3(0.5f, 0.5f, 1.0f));
+	platformMaterials.upload();
+	platformShaders.setSampler("material.textures", 0);
+	platformShaders.setSampler("shadowMaps", 1);
+	platformShaders.setSampler("pointShadowMap", 2);
+
+	vector<PlatformInstance> platformInstances;
+	glm::mat4 model = glm::mat4(1.0f);
+	// table
+	model = glm::translate(model, glm::vec3(-1.0f, -1.0f, -4.5f));
+	model = glm::scale(model, glm::vec3(15.0, 2.0, 15.0));
+	platformInstances.push_back(
+	    {model,
+	     glm::vec3(platformDiffuse, platformSpecular, platformNormal)});
+	// legs
+	for (int i = 0; i < 4; i++) {
+		model = glm::mat4(1.0f);
+		model = glm::translate(model,
+				       glm::vec3(legPositions[i * 3],
+						 legPositions[i * 3 + 1],
+						 legPositions[i * 3 + 2]));
+		model = glm::scale(model, glm::vec3(2.0, 15.0, 2.0));
+		platformInstances.push_back(
+		    {model, glm::vec3(legDiffuse, noSpecular, flatNormal)});
+	}
+	// pot
+	model = glm::mat4(1.0f);
+	model = glm::translate(model, glm::vec3(grassPotPosition[0],
+						grassPotPosition[1],
+						grassPotPosition[2]));
+	model = glm::scale(model, glm::vec3(2.5, 2.5, 2.5));
+	platformInstances.push_back(
+	    {model, glm::vec3(plastic, noSpecular, flatNormal)});
+	// land
+	model = glm::mat4(1.0f);
+	model = glm::translate(model, glm::vec3(grassPotPosition[0],
+						grassPotPosition[1] + 1.28f,
+						grassPotPosition[2]));
+	model = glm::scale(model, glm::vec3(2.5, 0.05, 2.5));
+	platformInstances.push_back(
+	    {model, glm::vec3(land, noSpecular, flatNormal)});
+
+	glBindBuffer(GL_ARRAY_BUFFER, platformInstanceVBO);
+	glBufferData(GL_ARRAY_BUFFER,
+		     platformInstances.size() * sizeof(PlatformInstance),
+		     platformInstances.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// the platform is the static shadow caster, its bounds set the depth
+	// range of the shadow cascades
+	glm::vec3 staticMin(INFINITY), staticMax(-INFINITY);
+	for (const PlatformInstance &instance : platformInstances)
+		for (int corner = 0; corner < 8; corner++) {
+			glm::vec3 p = glm::vec3(
+			    instance.model *
+			    glm::vec4(corner & 1 ? 0.5f : -0.5f,
+				      corner & 2 ? 0.5f : -0.5f,
+				      corner & 4 ? 0.5f : -0.5f, 1.0f));
+			staticMin = glm::min(staticMin, p);
+			staticMax = glm::max(staticMax, p);
+		}
+
+	std::string cupsDiffusePath =
+	    FileSystem::getPath("resources/objects/cup/coffee_cup.jpg");
+	unsigned int cupsDiffuse = load2DTexture(cupsDiffusePath.c_str());
 
 	stbi_set_flip_vertically_on_load(false);
 	grassShader.use();
-	unsigned int grass = load2DTexture(
-	    FileSystem::getPath("resources/textures/grass.png").c_str());
+	std::string grassPath =
+	    FileSystem::getPath("resources/textures/grass.png");
+	unsigned int grass = load2DTexture(grassPath.c_str());
 	grassShader.setInt("texture1", 3);
 	stbi_set_flip_vertically_on_load(true);
 
 	// load models
 	// -----------
-	Model cupObject("resources/objects/cup/coffee_cup.obj");
+	// nothing reads the cup's vertices back, only the GL buffers are kept
+	Model cupObject("resources/objects/cup/coffee_cup.obj", false, &jobs,
+			false);
 	// cupObject.SetShaderTextureNamePrefix("material.");
+	cupObject.SetSamplerUnits(shaderGeometryPass);
+
+	// edits to shaders and textures are picked up while running
+	AssetReloader reloader;
+	reloader.watch(FileSystem::getPath("resources/shaders"));
+	reloader.watch(FileSystem::getPath("resources/shaders/include"));
+	reloader.addShader(shaderGeometryPass);
+	reloader.addShaders(lightingPassShaders);
+	reloader.addShaders(ssaoShaders);
+	reloader.addShader(ssaoBlurShader);
+	reloader.addShader(bloomDownsampleShader);
+	reloader.addShader(bloomUpsampleShader);
+	reloader.addShaders(tonemapShaders);
+	reloader.addShaders(platformShaders);
+	reloader.addShaders(shadowShaders);
+	reloader.addShaders(pointShadowShaders);
+	reloader.addShader(grassShader);
+	reloader.addShader(skyboxShader);
+	for (unsigned int i = 0; i < faces.size(); i++)
+		reloader.addTexture(cubemapTexture,
+				    GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+				    faces[i], false);
+	for (unsigned int i = 0; i < platformTextures.size(); i++)
+		reloader.addTextureLayer(platformMaterials, i,
+					 platformTextures[i]);
+	reloader.addTexture(cupsDiffuse, GL_TEXTURE_2D, cupsDiffusePath, true);
+	reloader.addTexture(grass, GL_TEXTURE_2D, grassPath, false);
+	for (const Texture &texture : cupObject.textures_loaded)
+		reloader.addTexture(texture.id, GL_TEXTURE_2D,
+				    cupObject.directory + '/' + texture.path,
+				    true);
+	if (!headless)
+		reloader.start();
 
 	PointLight &pointLight = programState->pointLight;
 	pointLight.position = glm::vec3(4.0f, 4.0, 0.0);
@@ -420,73 +1127,305 @@ auto main() -> int
 	pointLight.linear = 0.09f;
 	pointLight.quadratic = 0.032f;
 
-	shaderLightingPass.use();
-	shaderLightingPass.setInt("gPosition", 0);
-	shaderLightingPass.setInt("gNormal", 1);
-	shaderLightingPass.setInt("gAlbedoSpec", 2);
+	lightingPassShaders.setSampler("gPosition", 0);
+	lightingPassShaders.setSampler("gNormal", 1);
+	lightingPassShaders.setSampler("gAlbedoSpec", 2);
+	lightingPassShaders.setSampler("pointShadowMap", 3);
+	lightingPassShaders.setSampler("ssao", 4);
+	ssaoShaders.setSampler("gPosition", 0);
+	ssaoShaders.setSampler("gNormal", 1);
+	ssaoShaders.setSampler("kernel", 2);
+	ssaoShaders.setSampler("noise", 3);
+	ssaoBlurShader.use();
+	ssaoBlurShader.setInt("occlusion", 0);
+	bloomDownsampleShader.use();
+	bloomDownsampleShader.setInt("source", 0);
+	bloomUpsampleShader.use();
+	bloomUpsampleShader.setInt("source", 0);
+	tonemapShaders.setSampler("scene", 0);
+	tonemapShaders.setSampler("bloom", 1);
+
+	// textures carry no filtering state, every pass binds the samplers
+	// for the units it samples from
+	SamplerCache samplers;
+
+	// per-pass GPU times, shown in the "GPU profiler" window
+	GpuProfiler gpuProfiler;
+
+	// the camera of the last two simulation steps, frames show it in
+	// between
+	FixedTimestep timestep(1.0f / simulationRate);
+	glm::vec3 previousPosition = programState->camera.Position;
 
 	// draw in wireframe
 	// glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
 	// render loop
 	// -----------
-	while (!glfwWindowShouldClose(window)) {
-		// per-frame time logic
-		// --------------------
-		float currentFrame = glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
+	unsigned int frameCount = 0;
+	FrameStats frameStats;
+	double firstFrameTime = 0.0;
+	bool fixedLength = headless || benchmarking || replaying;
+	unsigned int frameTotal =
+	    goldenTesting  ? goldenImages.totalFrames()
+	    : benchmarking ? benchmark.totalFrames()
+	    : replaying    ? inputLog.frameCount()
+			   : fixedFrames;
+	if (!recordFile.empty() && !inputLog.startRecording(recordFile))
+		return -1;
+	if (fixedLength)
+		frameStats.reserve(frameTotal);
+	// heap allocations of the main and the render thread per frame
+	FrameAllocations mainAllocations(ALLOCATION_WARMUP_FRAMES);
+	FrameAllocations renderAllocations(ALLOCATION_WARMUP_FRAMES);
+
+	// renders a frame the main thread described, on the render thread
+	// unless --single-thread; everything it touches besides the packet is
+	// only used by it until the loop ends
+	RenderStats renderStats;
+	std::mutex renderStatsMutex;
+	int swapInterval = -2;
+	double previousFrameDone = 0.0;
+	// heap allocations made by the model draws, Mesh::Draw should make
+	// none
+	unsigned long long drawAllocations = 0;
+	// scratch memory of the frame being rendered
+	FrameArena renderArena;
+	// directional light shadows, only used by the render thread
+	ShadowCascades shadows;
+	// point light shadows, and where the cup was when they were last
+	// brought up to date
+	PointShadows pointShadows;
+	glm::mat4 shadowedCupModel = glm::mat4(1.0f);
+	glm::vec3 shadowedCupMin(INFINITY), shadowedCupMax(-INFINITY);
+	// ambient occlusion of the g-buffer
+	Ssao ssao;
+	// the HDR scene and its bloom
+	HdrBloom hdr;
+	auto renderFrame = [&](RenderPacket &packet) {
+		CPU_ZONE("Render");
+		renderAllocations.begin();
+		renderArena.reset();
+		ProgramState &state = packet.state;
+		Camera &camera = packet.camera;
+		if (window && packet.swapInterval != swapInterval) {
+			swapInterval = packet.swapInterval;
+			glfwSwapInterval(swapInterval);
+		}
+		glViewport(0, 0, packet.viewportWidth, packet.viewportHeight);
+
+		glm::mat4 cupModel = glm::mat4(1.0f);
+		cupModel = glm::translate(cupModel, state.cupPosition);
+		cupModel = glm::scale(cupModel, glm::vec3(state.cupScale));
+
+		// the shadow passes are timed too, so the frame starts first
+		gpuProfiler.enabled = state.gpuProfilerEnabled;
+		gpuProfiler.beginFrame();
+
+		// 0. shadow cascades of the directional light: the platform
+		// comes from the cache unless its cascade moved, the cup is
+		// drawn on top every frame
+		// -----------------------------------------------------------
+		if (state.shadowsEnabled) {
+			shadows.configure(state.shadowCascades,
+					  state.shadowResolution);
+			shadows.update(camera.GetViewMatrix(),
+				       glm::radians(camera.Zoom),
+				       (float)SCR_WIDTH / (float)SCR_HEIGHT,
+				       0.1f, state.shadowDistance,
+				       state.shadowSplitLambda,
+				       state.dirLightDirection, staticMin,
+				       staticMax);
+			shadows.beginPass();
+			Shader &staticCasters = shadowShaders.get({1});
+			Shader &dynamicCasters = shadowShaders.get({0});
+			for (int i = 0; i < shadows.count(); i++) {
+				gpuProfiler.begin(ShadowCascades::passName(i));
+				if (shadows.beginStatic(i)) {
+					staticCasters.use();
+					staticCasters.setMat4(
+					    "lightSpace",
+					    shadows.lightSpace(i));
+					glBindVertexArray(platformVAO);
+					glDrawElementsInstanced(
+					    GL_TRIANGLES, 36, GL_UNSIGNED_INT,
+					    nullptr, platformInstances.size());
+				}
+				shadows.beginDynamic(i);
+				dynamicCasters.use();
+				dynamicCasters.setMat4("lightSpace",
+						       shadows.lightSpace(i));
+				cupObject.Draw(dynamicCasters, cupModel);
+				gpuProfiler.end();
+			}
+			glBindVertexArray(0);
+			shadows.endPass();
+			glViewport(0, 0, packet.viewportWidth,
+				   packet.viewportHeight);
+		}
 
-		// input
-		// -----
-		processInput(window);
+		// 0.5. cube map shadows of the point light: faces are redrawn
+		// when the light moved or the cup moved through them, a
+		// limited number per frame
+		// -----------------------------------------------------------
+		if (state.pointShadowsEnabled) {
+			gpuProfiler.begin("Point shadows");
+			pointShadows.configure(1, state.pointShadowResolution);
+			pointShadows.setLight(
+			    0, state.pointLight.position,
+			    PointShadows::attenuationRange(
+				state.pointLight.constant,
+				state.pointLight.linear,
+				state.pointLight.quadratic));
+			if (cupModel != shadowedCupModel) {
+				pointShadows.touch(shadowedCupMin,
+						   shadowedCupMax);
+				cupObject.Bounds(cupModel, shadowedCupMin,
+						 shadowedCupMax);
+				pointShadows.touch(shadowedCupMin,
+						   shadowedCupMax);
+				shadowedCupModel = cupModel;
+			}
+			pointShadows.schedule(state.pointShadowBudget);
+			pointShadows.beginPass();
+			if (pointShadows.begin(0)) {
+				Shader &staticCasters =
+				    pointShadowShaders.get({1});
+				pointShadows.setCasterUniforms(staticCasters,
+							       0);
+				glBindVertexArray(platformVAO);
+				glDrawElementsInstanced(
+				    GL_TRIANGLES, 36, GL_UNSIGNED_INT,
+				    nullptr, platformInstances.size());
+				glBindVertexArray(0);
+				Shader &dynamicCasters =
+				    pointShadowShaders.get({0});
+				pointShadows.setCasterUniforms(dynamicCasters,
+							       0);
+				cupObject.Draw(dynamicCasters, cupModel);
+			}
+			pointShadows.endPass();
+			glViewport(0, 0, packet.viewportWidth,
+				   packet.viewportHeight);
+			gpuProfiler.end();
+		} else {
+			// the cup may move while they're off
+			pointShadows.invalidate();
+		}
 
 		// render
 		// ------
-		glClearColor(programState->clearColor.r,
-			     programState->clearColor.g,
-			     programState->clearColor.b, 1.0f);
+		gpuProfiler.begin("G-buffer");
+		// the scene is drawn in HDR, tonemapped into the screen at
+		// the end
+		hdr.configure(packet.viewportWidth, packet.viewportHeight,
+			      state.bloomResolution);
+		glBindFramebuffer(GL_FRAMEBUFFER, hdr.framebuffer());
+		glClearColor(state.clearColor.r,
+			     state.clearColor.g,
+			     state.clearColor.b, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		glEnable(GL_CULL_FACE);
+		samplers.setQuality(state.textureQuality);
 
 		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glm::mat4 projection = glm::perspective(
-		    glm::radians(programState->camera.Zoom),
-		    (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-		glm::mat4 view = programState->camera.GetViewMatrix();
-		glm::mat4 model = glm::mat4(1.0f);
+		// gPosition's alpha tells SSAO where nothing was drawn
+		const float nothing[] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glClearBufferfv(GL_COLOR, 0, nothing);
+		glm::mat4 projection =
+		    glm::perspective(glm::radians(camera.Zoom),
+				     (float)SCR_WIDTH / (float)SCR_HEIGHT,
+				     0.1f, 100.0f);
+		glm::mat4 view = camera.GetViewMatrix();
+		model = glm::mat4(1.0f);
 		shaderGeometryPass.use();
 		shaderGeometryPass.setMat4("projection", projection);
 		shaderGeometryPass.setMat4("view", view);
 
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, programState->cupPosition);
-		model = glm::scale(model, glm::vec3(programState->cupScale));
-		shaderGeometryPass.setMat4("model", model);
-
+		// Mesh::Draw binds the model's textures to fixed units
+		for (int unit = 0; unit < MESH_TEXTURE_UNITS; unit++)
+			glBindSampler(unit, samplers.material());
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, cupsDiffuse);
-		cupObject.Draw(shaderGeometryPass);
-
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		unsigned long long allocations = AllocationCounter::count();
+		cupObject.Draw(shaderGeometryPass, cupModel);
+		drawAllocations += AllocationCounter::count() - allocations;
+		SamplerCache::unbind(MESH_TEXTURE_UNITS);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, hdr.framebuffer());
+		gpuProfiler.end();
+
+		// 1.5. ambient occlusion at reduced resolution, blurred in two
+		// passes; the lighting pass upsamples it
+		// -----------------------------------------------------------
+		ssao.configure(SCR_WIDTH, SCR_HEIGHT, state.ssaoQuality);
+		if (ssao.enabled()) {
+			gpuProfiler.begin("SSAO");
+			Shader &occlusionShader =
+			    ssaoShaders.get({ssao.kernelSize()});
+			ssao.beginOcclusion(occlusionShader, view, projection,
+					    samplers);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, gPosition);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, gNormal);
+			for (unsigned int unit = 0; unit < 2; unit++)
+				glBindSampler(unit,
+					      samplers.get(SAMPLER_NEAREST,
+							   GL_CLAMP_TO_EDGE));
+			renderQuad();
+			SamplerCache::unbind(4);
+			gpuProfiler.end();
+
+			gpuProfiler.begin("SSAO blur");
+			ssao.beginBlur(ssaoBlurShader, true, samplers);
+			renderQuad();
+			ssao.beginBlur(ssaoBlurShader, false, samplers);
+			renderQuad();
+			SamplerCache::unbind(1);
+			gpuProfiler.end();
+			glBindFramebuffer(GL_FRAMEBUFFER, hdr.framebuffer());
+			glViewport(0, 0, packet.viewportWidth,
+				   packet.viewportHeight);
+		}
 
 		// 2. lighting pass: calculate lighting by iterating over a
 		// screen filled quad pixel-by-pixel using the gbuffer's
 		// content.
 		// -----------------------------------------------------------------------------------------------------------------------
+		gpuProfiler.begin("Lighting");
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		Shader &shaderLightingPass = lightingPassShaders.get(
+		    {1, state.pointShadowsEnabled, ssao.enabled()});
 		shaderLightingPass.use();
+		if (ssao.enabled()) {
+			shaderLightingPass.setMat4("view", view);
+			glActiveTexture(GL_TEXTURE4);
+			glBindTexture(GL_TEXTURE_2D, ssao.texture());
+			glBindSampler(4, samplers.get(SAMPLER_NEAREST,
+						      GL_CLAMP_TO_EDGE));
+		}
+		if (state.pointShadowsEnabled) {
+			pointShadows.setUniforms(shaderLightingPass, 0);
+			glActiveTexture(GL_TEXTURE3);
+			glBindTexture(GL_TEXTURE_CUBE_MAP,
+				      pointShadows.texture(0));
+			glBindSampler(3, samplers.shadow());
+		}
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, gPosition);
 		glActiveTexture(GL_TEXTURE1);
 		glBindTexture(GL_TEXTURE_2D, gNormal);
 		glActiveTexture(GL_TEXTURE2);
 		glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+		for (unsigned int unit = 0; unit < 3; unit++)
+			glBindSampler(unit, samplers.get(SAMPLER_NEAREST,
+							 GL_CLAMP_TO_EDGE));
 		// send light relevant uniforms
 
 		shaderLightingPass.setVec3("lights[0].Position",
-					   programState->pointLight.position);
+					   state.pointLight.position);
 		shaderLightingPass.setVec3("lights[0].Color",
 					   glm::vec3(0.5, 0.5, 0.5));
 		// update attenuation parameters and calculate radius
@@ -495,145 +1434,113 @@ auto main() -> int
 		shaderLightingPass.setFloat("lights[0].Linear", linear);
 		shaderLightingPass.setFloat("lights[0].Quadratic", quadratic);
 
-		shaderLightingPass.setVec3("viewPos",
-					   programState->camera.Position);
+		shaderLightingPass.setVec3("viewPos", camera.Position);
 		// finally render quad
 		renderQuad();
+		SamplerCache::unbind(5);
+		gpuProfiler.end();
 
-		// 2.5. copy content of geometry's depth buffer to default
-		// framebuffer's depth buffer
+		// 2.5. copy content of geometry's depth buffer to the HDR
+		// scene's depth buffer
 		// ----------------------------------------------------------------------------------
+		gpuProfiler.begin("Depth blit");
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
-				  0); // write to default framebuffer
-		// blit to default framebuffer. Note that this may or may not
-		// work as the internal formats of both the FBO and default
-		// framebuffer have to match. the internal formats are
-		// implementation defined. This works on all of my systems, but
-		// if it doesn't on yours you'll likely have to write to the
-		// depth buffer in another shader stage (or somehow see to match
-		// the default framebuffer's internal format with the FBO's
-		// internal format).
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, hdr.framebuffer());
+		// the internal formats of both depth buffers have to match,
+		// the scene's is created with the g-buffer's
 		glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH,
 				  SCR_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
+		glBindFramebuffer(GL_FRAMEBUFFER, hdr.framebuffer());
+		gpuProfiler.end();
+
+		gpuProfiler.begin("Platform");
+		Shader &platformShader =
+		    platformShaders.get({state.spotLightEnabled,
+					 state.normalMapsEnabled,
+					 state.shadowsEnabled,
+					 state.pointShadowsEnabled});
 		platformShader.use();
 
-		platformShader.setVec3("dirLight.direction", -0.2f, -1.0f,
-				       -0.3f);
+		platformShader.setVec3("dirLight.direction",
+				       state.dirLightDirection);
 		platformShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
 		platformShader.setVec3("dirLight.diffuse", 0.15f, 0.15f, 0.15f);
 		platformShader.setVec3("dirLight.specular", 0.3f, 0.3f, 0.3f);
 
 		platformShader.setVec3("pointLight.position",
-				       pointLight.position);
+				       state.pointLight.position);
 		platformShader.setVec3("pointLight.ambient",
-				       pointLight.ambient);
+				       state.pointLight.ambient);
 		platformShader.setVec3("pointLight.diffuse",
-				       pointLight.diffuse);
+				       state.pointLight.diffuse);
 		platformShader.setVec3("pointLight.specular",
-				       pointLight.specular);
+				       state.pointLight.specular);
 		platformShader.setFloat("pointLight.constant",
-					pointLight.constant);
-		platformShader.setFloat("pointLight.linear", pointLight.linear);
+					state.pointLight.constant);
+		platformShader.setFloat("pointLight.linear",
+					state.pointLight.linear);
 		platformShader.setFloat("pointLight.quadratic",
-					pointLight.quadratic);
-		platformShader.setVec3("viewPos",
-				       programState->camera.Position);
+					state.pointLight.quadratic);
+		platformShader.setVec3("viewPos", camera.Position);
 		platformShader.setFloat("material.shininess", 32.0f);
 
-		platformShader.setVec3("spotLight.position",
-				       programState->camera.Position);
-		platformShader.setVec3("spotLight.direction",
-				       programState->camera.Front);
-		platformShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-		if (programState->spotLightEnabled) {
+		// the variant without the flashlight has no spotLight uniforms
+		if (state.spotLightEnabled) {
+			platformShader.setVec3("spotLight.position",
+					       camera.Position);
+			platformShader.setVec3("spotLight.direction",
+					       camera.Front);
+			platformShader.setVec3("spotLight.ambient", 0.0f, 0.0f,
+					       0.0f);
 			platformShader.setVec3("spotLight.diffuse", 1.0f, 1.0f,
 					       1.0f);
 			platformShader.setVec3("spotLight.specular", 1.0f, 1.0f,
 					       1.0f);
-		} else {
-			platformShader.setVec3("spotLight.diffuse", 0.0f, 0.0f,
-					       0.0f);
-			platformShader.setVec3("spotLight.specular", 0.0f, 0.0f,
-					       0.0f);
+			platformShader.setFloat("spotLight.constant", 1.0f);
+			platformShader.setFloat("spotLight.linear", 0.09);
+			platformShader.setFloat("spotLight.quadratic", 0.032);
+			platformShader.setFloat("spotLight.cutOff",
+						glm::cos(glm::radians(12.5f)));
+			platformShader.setFloat("spotLight.outerCutOff",
+						glm::cos(glm::radians(15.0f)));
 		}
-		platformShader.setFloat("spotLight.constant", 1.0f);
-		platformShader.setFloat("spotLight.linear", 0.09);
-		platformShader.setFloat("spotLight.quadratic", 0.032);
-		platformShader.setFloat("spotLight.cutOff",
-					glm::cos(glm::radians(12.5f)));
-		platformShader.setFloat("spotLight.outerCutOff",
-					glm::cos(glm::radians(15.0f)));
-
-		model = glm::mat4(1.0f); // make sure to initialize matrix to
-					 // identity matrix first
-		model = glm::translate(model, glm::vec3(-1.0f, -1.0f, -4.5f));
-		model = glm::scale(model, glm::vec3(15.0, 2.0, 15.0));
-
-		platformShader.setMat4("model", model);
+
 		platformShader.setMat4("view", view);
 		platformShader.setMat4("projection", projection);
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, platformDiffuse);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, platformSpecular);
-
-		// don't forget to enable shader before setting uniforms
-		glBindVertexArray(
-		    platformVAO); // seeing as we only have a single VAO there's
-				  // no need to bind it every time, but we'll do
-				  // so to keep things a bit more organized
-		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
-
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		// legs
-		for (int i = 0; i < 4; i++) {
-			model = glm::mat4(1.0f);
-			model = glm::translate(
-			    model, glm::vec3(legPositions[i * 3],
-					     legPositions[i * 3 + 1],
-					     legPositions[i * 3 + 2]));
-			model = glm::scale(model, glm::vec3(2.0, 15.0, 2.0));
-			platformShader.setMat4("model", model);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, legDiffuse);
-			glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT,
-				       nullptr);
+		if (state.shadowsEnabled) {
+			shadows.setUniforms(platformShader);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, shadows.texture());
+			glBindSampler(1, samplers.shadow());
+		}
+		if (state.pointShadowsEnabled) {
+			pointShadows.setUniforms(platformShader, 0);
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_CUBE_MAP,
+				      pointShadows.texture(0));
+			glBindSampler(2, samplers.shadow());
 		}
 
-		// pot
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, glm::vec3(grassPotPosition[0],
-							grassPotPosition[1],
-							grassPotPosition[2]));
-		model = glm::scale(model, glm::vec3(2.5, 2.5, 2.5));
-		platformShader.setMat4("model", model);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, plastic);
-		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
-		// land
-		model = glm::mat4(1.0f);
-		model =
-		    glm::translate(model, glm::vec3(grassPotPosition[0],
-						    grassPotPosition[1] + 1.28f,
-						    grassPotPosition[2]));
-		model = glm::scale(model, glm::vec3(2.5, 0.05, 2.5));
-		platformShader.setMat4("model", model);
+		// table, legs, pot and land in one instanced draw, every
+		// instance picks its material layers from the texture array
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, land);
-		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, platformMaterials.ID);
+		glBindSampler(0, samplers.material());
+		glBindVertexArray(platformVAO);
+		glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT,
+					nullptr, platformInstances.size());
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		SamplerCache::unbind(3);
+		gpuProfiler.end();
 
 		// grass
+		gpuProfiler.begin("Grass");
 		glDisable(GL_CULL_FACE);
 		grassShader.use();
 		glBindVertexArray(grassVAO);
 		glActiveTexture(GL_TEXTURE3);
 		glBindTexture(GL_TEXTURE_2D, grass);
+		glBindSampler(3, samplers.material());
 		model = glm::mat4(1.0f);
 		model = glm::translate(model, glm::vec3(grassPosition[0],
 							grassPosition[1],
@@ -645,39 +1552,448 @@ auto main() -> int
 		grassShader.setMat4("projection", projection);
 
 		glDrawArrays(GL_TRIANGLES, 0, 6);
+		SamplerCache::unbind(4);
+		gpuProfiler.end();
 
 		// draw skybox as last
+		gpuProfiler.begin("Skybox");
 		glDepthFunc(GL_LEQUAL); // change depth function so depth test
 					// passes when values are equal to depth
 					// buffer's content
 		skyboxShader.use();
-		view = glm::mat4(
-		    glm::mat3(programState->camera
-				  .GetViewMatrix())); // remove translation from
-						      // the view matrix
+		// remove translation from the view matrix
+		view = glm::mat4(glm::mat3(camera.GetViewMatrix()));
 		skyboxShader.setMat4("view", view);
 		skyboxShader.setMat4("projection", projection);
 		// skybox cube
 		glBindVertexArray(skyboxVAO);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+		glBindSampler(0,
+			      samplers.get(SAMPLER_LINEAR, GL_CLAMP_TO_EDGE));
 		glDrawArrays(GL_TRIANGLES, 0, 36);
 		glBindVertexArray(0);
 		glDepthFunc(GL_LESS); // set depth function back to default
+		SamplerCache::unbind(1);
+		gpuProfiler.end();
+
+		// bloom: down the mip chain, then back up adding every mip's
+		// blur to the one above
+		if (hdr.bloomEnabled()) {
+			gpuProfiler.begin("Bloom downsample");
+			for (int mip = 0; mip < hdr.mipCount(); mip++) {
+				hdr.beginDownsample(bloomDownsampleShader, mip,
+						    samplers);
+				renderQuad();
+			}
+			SamplerCache::unbind(1);
+			gpuProfiler.end();
+			gpuProfiler.begin("Bloom upsample");
+			for (int mip = hdr.mipCount() - 1; mip > 0; mip--) {
+				hdr.beginUpsample(bloomUpsampleShader, mip,
+						  samplers);
+				renderQuad();
+			}
+			hdr.endUpsample();
+			SamplerCache::unbind(1);
+			gpuProfiler.end();
+		}
 
-		if (programState->ImGuiEnabled)
-			DrawImGui(programState);
+		// tonemapping into the screen
+		gpuProfiler.begin("Tonemap");
+		glBindFramebuffer(GL_FRAMEBUFFER, screenFBO);
+		glViewport(0, 0, packet.viewportWidth, packet.viewportHeight);
+		glDisable(GL_DEPTH_TEST);
+		hdr.beginTonemap(tonemapShaders.get({hdr.bloomEnabled()}),
+				 state.exposure, state.bloomStrength, samplers);
+		renderQuad();
+		glEnable(GL_DEPTH_TEST);
+		SamplerCache::unbind(2);
+		gpuProfiler.end();
+
+		if (ImDrawData *drawData = packet.imgui.get()) {
+			gpuProfiler.begin("ImGui");
+			ImGui_ImplOpenGL3_RenderDrawData(drawData);
+			gpuProfiler.end();
+		}
+
+		if (goldenTesting) {
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, screenFBO);
+			goldenImages.capture(packet.frame, SCR_WIDTH,
+					     SCR_HEIGHT);
+		}
 
-		// glfw: swap buffers and poll IO events (keys pressed/released,
-		// mouse moved etc.)
+		// glfw: swap buffers
 		// -------------------------------------------------------------------------------
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		if (window) {
+			CPU_ZONE("glfwSwapBuffers");
+			glfwSwapBuffers(window);
+		}
+		framePacer.endFrame(packet.inputTime, packet.lowLatency);
+		if (packet.lowLatency)
+			framePacer.waitForGpu();
+
+		if (fixedLength) {
+			// wait for the GPU so the frame time includes the
+			// rendering. Frames overlap with two threads, a frame's
+			// time is the time since the last one was done.
+			glFinish();
+			double done = getTime();
+			double ms = (done - std::max(packet.startTime,
+						     previousFrameDone)) *
+				    1000.0;
+			previousFrameDone = done;
+			if (packet.frame == 0)
+				firstFrameTime = ms;
+			else
+				frameStats.add(ms);
+			if (benchmarking)
+				benchmark.addFrameTime(packet.frame, ms);
+		}
+
+		// start rebuilding edited shaders and swap in the rebuilt ones
+		// and edited textures between frames, after the frame's timing
+		reloader.poll();
+
+		std::lock_guard<std::mutex> lock(renderStatsMutex);
+		renderStats.passes.clear();
+		for (size_t i = 0; i < gpuProfiler.passCount(); i++)
+			renderStats.passes.push_back(
+			    {gpuProfiler.passName(i), gpuProfiler.stats(i)});
+		renderStats.droppedQueries = gpuProfiler.droppedCount();
+		renderStats.shadowRedraws = shadows.staticRedrawCount();
+		renderStats.pointShadowRedraws = pointShadows.faceRedrawCount();
+		renderStats.pointShadowsPending = pointShadows.pendingCount();
+		renderStats.latencyAverage = framePacer.latencyAverage();
+		renderStats.latencyP95 =
+		    framePacer.latencyPercentile(0.95f, renderArena);
+		renderAllocations.end();
+		renderAllocations.endFrame(packet.frame);
+	};
+
+	// the render thread takes the context over until the loop ends
+	RenderThread<RenderPacket> renderThread;
+	if (!singleThread) {
+		if (window)
+			glfwMakeContextCurrent(nullptr);
+		else
+			headlessContext.release();
+		renderThread.start(
+		    [&]() {
+			    if (window)
+				    glfwMakeContextCurrent(window);
+			    else
+				    headlessContext.makeCurrent();
+		    },
+		    renderFrame,
+		    [&]() {
+			    if (window)
+				    glfwMakeContextCurrent(nullptr);
+			    else
+				    headlessContext.release();
+		    });
+	}
+	ThreadStats threadStats;
+	threadStats.threaded = renderThread.running();
+	double previousFrameStart = getTime();
+	// reused every frame, submit hands back one that was rendered
+	RenderPacket packet;
+	while (!(window && glfwWindowShouldClose(window)) &&
+	       (!fixedLength || frameCount < frameTotal)) {
+		// a startup trace ends before frame traceFrames + 1 begins
+		if (traceFrames > 0 && frameCount == traceFrames) {
+			CpuProfiler::stop(traceFile);
+			traceFrames = 0;
+		}
+		frameCount++;
+		if (allocationCheck &&
+		    frameCount == ALLOCATION_WARMUP_FRAMES + 1)
+			AllocationCounter::trackSites(true);
+		mainAllocations.begin();
+		CPU_ZONE("Frame");
+		packet.frame = frameCount - 1;
+
+		// frame pacing
+		// ------------
+		{
+			CPU_ZONE("FramePacer::beginFrame");
+			framePacer.beginFrame();
+			// the render thread waits for the GPU after every
+			// frame in low-latency mode, and this thread for it
+			if (framePacer.lowLatency && renderThread.running())
+				renderThread.waitIdle();
+		}
+		// input that arrived while waiting belongs to this frame
+		if (window && (framePacer.fpsLimit > 0.0f ||
+			       framePacer.lowLatency))
+			glfwPollEvents();
+		packet.inputTime = framePacer.inputRead();
+
+		// per-frame time logic
+		// --------------------
+		float currentFrame = getTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+		if (replaying)
+			deltaTime = inputLog.beginFrame(packet.frame);
+		inputLog.recordFrame(currentFrame, deltaTime);
+		packet.startTime = currentFrame;
+
+		// input
+		// -----
+		if (window || replaying)
+			processInput(window);
+
+		// simulation
+		// ----------
+		unsigned int steps = timestep.advance(deltaTime);
+		for (unsigned int i = 0; i < steps; i++) {
+			previousPosition = programState->camera.Position;
+			moveCamera(programState->camera, heldKeys,
+				   timestep.step);
+		}
+		if (benchmarking)
+			benchmark.apply(packet.frame, programState->camera);
+		if (goldenTesting)
+			goldenImages.apply(packet.frame, programState->camera);
+		// scripted poses are shown as they are
+		if (benchmarking || goldenTesting)
+			previousPosition = programState->camera.Position;
+
+		// the camera drawn from: its position between the last two
+		// steps, one step behind where the simulation would be at
+		// this time. The distance to that is the interpolation
+		// error. Looking around is not simulated, it always shows
+		// the latest direction.
+		packet.camera = programState->camera;
+		packet.camera.Position = timestep.interpolate(
+		    previousPosition, programState->camera.Position);
+		Camera exact = programState->camera;
+		moveCamera(exact, heldKeys, timestep.remainder());
+		timestep.addInterpolationError(
+		    glm::length(exact.Position - packet.camera.Position));
+
+		if (programState->ImGuiEnabled) {
+			CPU_ZONE("DrawImGui");
+			{
+				std::lock_guard<std::mutex> lock(
+				    renderStatsMutex);
+				threadStats.render = renderStats;
+			}
+			DrawImGui(programState, threadStats, timestep,
+				  framePacer);
+			packet.imgui.capture(ImGui::GetDrawData());
+		} else {
+			packet.imgui.capture(nullptr);
+		}
+
+		// hand the frame to the renderer
+		// ------------------------------
+		packet.state = *programState;
+		packet.swapInterval = framePacer.swapInterval();
+		packet.lowLatency = framePacer.lowLatency;
+		packet.viewportWidth = viewportWidth;
+		packet.viewportHeight = viewportHeight;
+		double mainDone = getTime();
+		float mainWait = 0.0f;
+		// the render thread's work isn't the main thread's, also when
+		// it runs here
+		mainAllocations.end();
+		if (renderThread.running()) {
+			renderThread.submit(packet);
+			RenderThread<RenderPacket>::Timing timing =
+			    renderThread.lastTiming();
+			mainWait = timing.mainWait;
+			threadStats.renderBusy = timing.renderBusy;
+			threadStats.renderWait = timing.renderWait;
+		} else {
+			renderFrame(packet);
+			threadStats.renderBusy =
+			    (getTime() - mainDone) * 1000.0;
+			threadStats.renderWait = 0.0f;
+		}
+		// the first frame has no previous one to measure from
+		if (frameCount > 1)
+			threadStats.add(
+			    (currentFrame - previousFrameStart) * 1000.0,
+			    (mainDone - currentFrame) * 1000.0, mainWait);
+		previousFrameStart = currentFrame;
+		mainAllocations.begin();
+
+		// glfw: poll IO events (keys pressed/released, mouse moved
+		// etc.)
+		// -------------------------------------------------------------------------------
+		if (window)
+			glfwPollEvents();
+		if (replaying) {
+			InputEvent e;
+			while (inputLog.nextEvent(e))
+				replayEvent(window, e);
+		}
+		mainAllocations.end();
+		mainAllocations.endFrame(frameCount - 1);
+	}
+	AllocationCounter::trackSites(false);
+	// the main thread takes the context back for the cleanup
+	if (renderThread.running()) {
+		renderThread.stop();
+		if (window)
+			glfwMakeContextCurrent(window);
+		else
+			headlessContext.makeCurrent();
+	}
+	inputLog.stopRecording();
+	if (CpuProfiler::capturing())
+		CpuProfiler::stop(traceFile);
+	if (benchmarking &&
+	    benchmark.writeJson(benchmarkOutput,
+				(const char *)glGetString(GL_RENDERER),
+				SCR_WIDTH, SCR_HEIGHT))
+		std::cout << "Benchmark results written to " << benchmarkOutput
+			  << std::endl;
+	bool goldenPassed = !goldenTesting || goldenImages.finish();
+	if (replaying) {
+		// matches between runs of the same log, whatever the timing
+		const Camera &c = programState->camera;
+		std::cout << "Replay: final camera position (" << c.Position.x
+			  << ", " << c.Position.y << ", " << c.Position.z
+			  << "), yaw " << c.Yaw << ", pitch " << c.Pitch
+			  << std::endl;
+	}
+	if (fixedLength) {
+		// the first frame also compiles the shader variants in use
+		std::cout << (headless ? "Headless: " : "Windowed: ")
+			  << frameCount << " frames at "
+			  << SCR_WIDTH << "x" << SCR_HEIGHT << " on "
+			  << glGetString(GL_RENDERER) << "\n"
+			  << "  first frame " << firstFrameTime << " ms\n"
+			  << "  min " << frameStats.min() << " ms, avg "
+			  << frameStats.average() << " ms, p50 "
+			  << frameStats.percentile(0.50) << " ms, p95 "
+			  << frameStats.percentile(0.95) << " ms, p99 "
+			  << frameStats.percentile(0.99) << " ms, max "
+			  << frameStats.max() << " ms ("
+			  << (frameStats.average() > 0.0
+				  ? 1000.0 / frameStats.average()
+				  : 0.0)
+			  << " fps)\n"
+			  << "  simulation " << timestep.stepCount()
+			  << " steps (avg " << timestep.averageStepCount()
+			  << ", max " << timestep.maxStepCount()
+			  << " per frame), interpolation error avg "
+			  << timestep.averageInterpolationError() << ", max "
+			  << timestep.maxInterpolationError() << "\n"
+			  << "  latency (input to GPU done) avg "
+			  << framePacer.latencyAverage() << " ms, p95 "
+			  << framePacer.latencyPercentile(0.95f) << " ms\n"
+			  << "  threads " << (singleThread ? "1" : "2")
+			  << ": frame avg " << threadStats.averageFrame()
+			  << " ms, main busy " << threadStats.averageMainBusy()
+			  << " ms, render busy "
+			  << threadStats.averageRenderBusy()
+			  << " ms, overlap "
+			  << threadStats.averageOverlap() * 100.0f << "%\n"
+			  << "  model draws allocated " << drawAllocations
+			  << " times\n"
+			  << "  heap allocations per frame after "
+			  << ALLOCATION_WARMUP_FRAMES << ": main avg "
+			  << mainAllocations.average() << ", max "
+			  << mainAllocations.max() << "; render avg "
+			  << renderAllocations.average() << ", max "
+			  << renderAllocations.max() << "\n"
+			  << "  GPU passes (avg ms):";
+		for (size_t i = 0; i < renderStats.passes.size(); i++)
+			std::cout << (i ? ", " : " ")
+				  << renderStats.passes[i].name << " "
+				  << renderStats.passes[i].stats.average;
+		std::cout << "\n  shadows: ";
+		if (programState->shadowsEnabled)
+			std::cout << shadows.count() << " cascades at "
+				  << shadows.resolution() << "x"
+				  << shadows.resolution() << ", "
+				  << renderStats.shadowRedraws
+				  << " static cascade redraws";
+		else
+			std::cout << "off";
+		std::cout << "\n  point shadows: ";
+		if (programState->pointShadowsEnabled)
+			std::cout << pointShadows.count() << " light at "
+				  << pointShadows.resolution() << "x"
+				  << pointShadows.resolution() << ", "
+				  << renderStats.pointShadowRedraws
+				  << " face redraws, at most "
+				  << programState->pointShadowBudget
+				  << " per frame, "
+				  << renderStats.pointShadowsPending
+				  << " pending";
+		else
+			std::cout << "off";
+		std::cout << "\n  SSAO: "
+			  << SSAO_QUALITY_NAMES[programState->ssaoQuality];
+		if (ssao.enabled())
+			std::cout << " at " << ssao.width() << "x"
+				  << ssao.height();
+		std::cout << "\n  HDR: exposure " << programState->exposure
+			  << ", bloom ";
+		if (hdr.bloomEnabled())
+			std::cout << hdr.mipCount() << " mips from "
+				  << hdr.mipWidth(0) << "x" << hdr.mipHeight(0)
+				  << ", strength "
+				  << programState->bloomStrength;
+		else
+			std::cout << "off";
+		std::cout << std::endl;
+	}
+	bool allocationsPassed = true;
+	if (allocationCheck) {
+		unsigned long long total =
+		    mainAllocations.total() + renderAllocations.total();
+		allocationsPassed = total == 0;
+		std::cout << "Allocation check: "
+			  << (allocationsPassed ? "passed" : "failed") << ", "
+			  << total << " allocations ("
+			  << mainAllocations.totalBytesAllocated() +
+				 renderAllocations.totalBytesAllocated()
+			  << " bytes) in "
+			  << mainAllocations.framesAllocating() << " main and "
+			  << renderAllocations.framesAllocating()
+			  << " render frames" << std::endl;
+		AllocationCounter::Site sites[10];
+		size_t count = allocationsPassed
+				   ? 0
+				   : AllocationCounter::sites(sites, 10);
+		for (size_t i = 0; i < count && i < 10; i++)
+			std::cout << "  " << sites[i].count << " allocations, "
+				  << sites[i].bytes << " bytes from "
+				  << AllocationCounter::describe(
+					 sites[i].caller)
+				  << std::endl;
+	}
+	if (headless) {
+		glDeleteFramebuffers(1, &screenFBO);
+		glDeleteRenderbuffers(1, &screenColor);
+		glDeleteRenderbuffers(1, &screenDepth);
 	}
 	glDeleteVertexArrays(1, &platformVAO);
 	glDeleteBuffers(1, &platformVBO);
 	glDeleteBuffers(1, &platformEBO);
-	programState->SaveToFile("resources/program_state.txt");
+	glDeleteBuffers(1, &platformInstanceVBO);
+	glDeleteTextures(1, &platformMaterials.ID);
+	cupObject.clear();
+	shadows.clear();
+	pointShadows.clear();
+	ssao.clear();
+	hdr.clear();
+	samplers.clear();
+	gpuProfiler.clear();
+	framePacer.clear();
+	if (headless) {
+		delete programState;
+		headlessContext.destroy();
+		return goldenPassed && allocationsPassed ? 0 : 1;
+	}
+	if (!defaultState)
+		programState->SaveToFile("resources/program_state.txt");
 	delete programState;
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
@@ -688,6 +2004,17 @@ auto main() -> int
 	return 0;
 }
 
+double getTime()
+{
+	if (!headless)
+		return glfwGetTime();
+	static std::chrono::steady_clock::time_point start =
+	    std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+					     start)
+	    .count();
+}
+
 // renderQuad() renders a 1x1 XY quad in NDC
 // -----------------------------------------
 unsigned int quadVAO = 0;
@@ -726,17 +2053,47 @@ void renderQuad()
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
 {
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	CPU_ZONE("processInput");
+	if (window && glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		programState->camera.ProcessKeyboard(FORWARD, deltaTime * 5);
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		programState->camera.ProcessKeyboard(BACKWARD, deltaTime * 5);
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		programState->camera.ProcessKeyboard(LEFT, deltaTime * 5);
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		programState->camera.ProcessKeyboard(RIGHT, deltaTime * 5);
+	unsigned int keys = 0;
+	if (inputLog.replaying()) {
+		keys = inputLog.heldKeys();
+	} else {
+		const int movementKeys[] = {GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A,
+					    GLFW_KEY_D};
+		for (int i = 0; i < 4; i++)
+			if (glfwGetKey(window, movementKeys[i]) == GLFW_PRESS)
+				keys |= 1 << i;
+	}
+	inputLog.recordHeldKeys(keys);
+	heldKeys = keys;
+}
+
+// moves the camera as if keys were held for dt seconds
+void moveCamera(Camera &camera, unsigned int keys, float dt)
+{
+	const Camera_Movement directions[] = {FORWARD, BACKWARD, LEFT, RIGHT};
+	for (Camera_Movement direction : directions)
+		if (keys & (1 << direction))
+			camera.ProcessKeyboard(direction, dt * 5);
+}
+
+// hands a window event of a replayed log to its callback
+void replayEvent(GLFWwindow *window, const InputEvent &e)
+{
+	switch (e.type) {
+	case INPUT_CURSOR:
+		mouse_callback(window, e.x, e.y);
+		break;
+	case INPUT_SCROLL:
+		scroll_callback(window, 0.0, e.y);
+		break;
+	case INPUT_KEY:
+		key_callback(window, e.key, 0, e.action, e.mods);
+		break;
+	}
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback
@@ -746,14 +2103,17 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
 	// make sure the viewport matches the new window dimensions; note that
 	// width and height will be significantly larger than specified on
-	// retina displays.
-	glViewport(0, 0, width, height);
+	// retina displays. The context belongs to the render thread, it picks
+	// the size up with the next frame.
+	viewportWidth = width;
+	viewportHeight = height;
 }
 
 // glfw: whenever the mouse moves, this callback is called
 // -------------------------------------------------------
 void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 {
+	inputLog.recordCursor(xpos, ypos);
 	if (firstMouse) {
 		lastX = xpos;
 		lastY = ypos;
@@ -775,12 +2135,14 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 // ----------------------------------------------------------------------
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 {
+	inputLog.recordScroll(yoffset);
 	programState->camera.ProcessMouseScroll(yoffset);
 }
 
-void DrawImGui(ProgramState *programState)
+// builds the UI, the caller captures the draw data for the render thread
+void DrawImGui(ProgramState *programState, const ThreadStats &threadStats,
+	       const FixedTimestep &timestep, FramePacer &framePacer)
 {
-	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 
@@ -805,6 +2167,28 @@ void DrawImGui(ProgramState *programState)
 		ImGui::DragFloat("pointLight.quadratic",
 				 &programState->pointLight.quadratic, 0.05, 0.0,
 				 1.0);
+		ImGui::Checkbox("Normal maps",
+				&programState->normalMapsEnabled);
+		// the combos edit ints, copied back into the enums
+		int textureQuality = programState->textureQuality;
+		if (ImGui::Combo("Texture quality", &textureQuality,
+				 TEXTURE_QUALITY_NAMES, TEXTURE_QUALITY_COUNT))
+			programState->textureQuality =
+			    (TextureQuality)textureQuality;
+		int ssaoQuality = programState->ssaoQuality;
+		if (ImGui::Combo("SSAO", &ssaoQuality, SSAO_QUALITY_NAMES,
+				 SSAO_QUALITY_COUNT))
+			programState->ssaoQuality = (SsaoQuality)ssaoQuality;
+		ImGui::SliderFloat("Exposure", &programState->exposure, 0.1f,
+				   5.0f);
+		int bloomResolution = programState->bloomResolution;
+		if (ImGui::Combo("Bloom", &bloomResolution,
+				 BLOOM_RESOLUTION_NAMES,
+				 BLOOM_RESOLUTION_COUNT))
+			programState->bloomResolution =
+			    (BloomResolution)bloomResolution;
+		ImGui::SliderFloat("Bloom strength",
+				   &programState->bloomStrength, 0.0f, 0.2f);
 		ImGui::End();
 	}
 
@@ -819,17 +2203,139 @@ void DrawImGui(ProgramState *programState)
 		ImGui::Checkbox(
 		    "Camera mouse update",
 		    &programState->CameraMouseMovementUpdateEnabled);
+		ImGui::Separator();
+		ImGui::Text("Simulation: %.0f Hz", 1.0f / timestep.step);
+		ImGui::Text("Steps: last %u, avg %.2f, max %u",
+			    timestep.lastStepCount(),
+			    timestep.averageStepCount(),
+			    timestep.maxStepCount());
+		ImGui::Text("Dropped: %.3f s", timestep.dropped());
+		ImGui::Text("Interpolation error: avg %.4f, max %.4f",
+			    timestep.averageInterpolationError(),
+			    timestep.maxInterpolationError());
+		ImGui::End();
+	}
+
+	{
+		ImGui::Begin("Frame pacing");
+		int vsync = framePacer.vsync;
+		if (ImGui::Combo("Vsync", &vsync, VSYNC_MODE_NAMES,
+				 VSYNC_MODE_COUNT))
+			framePacer.vsync = (VsyncMode)vsync;
+		if (framePacer.vsync == VSYNC_ADAPTIVE &&
+		    !framePacer.adaptiveSupported)
+			ImGui::Text("Adaptive vsync unsupported, using vsync");
+		ImGui::SliderFloat("FPS limit (0 = off)", &framePacer.fpsLimit,
+				   0.0f, 240.0f, "%.0f");
+		ImGui::Checkbox("Low latency (wait for GPU)",
+				&framePacer.lowLatency);
+		ImGui::Separator();
+		ImGui::Text("Frame: %.2f ms",
+			    1000.0f / ImGui::GetIO().Framerate);
+		ImGui::Text("Pacing wait: %.2f ms", framePacer.waitTime());
+		ImGui::Text("Latency (input to GPU done): avg %.2f, "
+			    "p95 %.2f ms",
+			    threadStats.render.latencyAverage,
+			    threadStats.render.latencyP95);
+		ImGui::Separator();
+		ImGui::Text("Render thread: %s",
+			    threadStats.threaded ? "on" : "off");
+		ImGui::Text("Main: busy %.2f, waiting %.2f ms",
+			    threadStats.mainBusy, threadStats.mainWait);
+		ImGui::Text("Render: busy %.2f, waiting %.2f ms",
+			    threadStats.renderBusy, threadStats.renderWait);
+		ImGui::Text("Overlap: %.0f%%", threadStats.overlap() * 100.0f);
+		ImGui::End();
+	}
+
+	{
+		// GPU times lag two frames behind, the ImGui row is the
+		// previous frame's UI
+		ImGui::Begin("GPU profiler");
+		ImGui::Checkbox("Enabled", &programState->gpuProfilerEnabled);
+		ImGui::Columns(6, "passes");
+		const char *headers[] = {"Pass", "Last", "Avg",
+					 "p50",	 "p95",	 "p99"};
+		for (const char *header : headers) {
+			ImGui::Text("%s", header);
+			ImGui::NextColumn();
+		}
+		ImGui::Separator();
+		float total = 0.0f;
+		for (const RenderStats::Pass &pass :
+		     threadStats.render.passes) {
+			const GpuProfiler::Stats &s = pass.stats;
+			total += s.average;
+			ImGui::Text("%s", pass.name);
+			ImGui::NextColumn();
+			const float values[] = {s.last, s.average, s.p50,
+						s.p95, s.p99};
+			for (float ms : values) {
+				ImGui::Text("%.3f", ms);
+				ImGui::NextColumn();
+			}
+		}
+		ImGui::Columns(1);
+		ImGui::Separator();
+		ImGui::Text("Total (avg): %.3f ms", total);
+		ImGui::Text("Dropped results: %lu",
+			    threadStats.render.droppedQueries);
+		ImGui::End();
+	}
+
+	{
+		ImGui::Begin("Shadows");
+		ImGui::Checkbox("Enabled", &programState->shadowsEnabled);
+		ImGui::DragFloat3("Light direction",
+				  (float *)&programState->dirLightDirection,
+				  0.01f, -1.0f, 1.0f);
+		ImGui::SliderInt("Cascades", &programState->shadowCascades, 1,
+				 ShadowCascades::MAX_CASCADES);
+		const char *resolutions[] = {"512", "1024", "2048", "4096"};
+		int resolution = 0;
+		while (resolution < 3 &&
+		       (512 << resolution) < programState->shadowResolution)
+			resolution++;
+		if (ImGui::Combo("Resolution", &resolution, resolutions, 4))
+			programState->shadowResolution = 512 << resolution;
+		ImGui::SliderFloat("Split lambda",
+				   &programState->shadowSplitLambda, 0.0f,
+				   1.0f);
+		ImGui::SliderFloat("Distance", &programState->shadowDistance,
+				   5.0f, 100.0f);
+		ImGui::Text("Static cascade redraws: %lu",
+			    threadStats.render.shadowRedraws);
+		ImGui::Separator();
+		ImGui::Checkbox("Point light",
+				&programState->pointShadowsEnabled);
+		const char *cubeResolutions[] = {"256", "512", "1024", "2048"};
+		int cubeResolution = 0;
+		while (cubeResolution < 3 &&
+		       (256 << cubeResolution) <
+			   programState->pointShadowResolution)
+			cubeResolution++;
+		if (ImGui::Combo("Cube resolution", &cubeResolution,
+				 cubeResolutions, 4))
+			programState->pointShadowResolution = 256
+							      << cubeResolution;
+		ImGui::SliderInt("Faces per frame",
+				 &programState->pointShadowBudget, 1,
+				 PointShadows::FACES);
+		ImGui::Text("Face redraws: %lu, pending %d",
+			    threadStats.render.pointShadowRedraws,
+			    threadStats.render.pointShadowsPending);
 		ImGui::End();
 	}
 
 	ImGui::Render();
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action,
 		  int mods)
 {
-	if (key == GLFW_KEY_F1 && action == GLFW_PRESS) {
+	inputLog.recordKey(key, action, mods);
+	// there's no ImGui without a window
+	if (key == GLFW_KEY_F1 && action == GLFW_PRESS && window) {
 		programState->ImGuiEnabled = !programState->ImGuiEnabled;
 		if (programState->ImGuiEnabled) {
 			programState->CameraMouseMovementUpdateEnabled = false;
@@ -840,6 +2346,22 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action,
 					 GLFW_CURSOR_DISABLED);
 		}
 	}
+	if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+		if (CpuProfiler::capturing())
+			CpuProfiler::stop(traceFile);
+		else
+			CpuProfiler::start();
+	}
+	if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+		// key times are relative to the first recorded pose
+		static double recordStart = getTime();
+		const Camera &c = programState->camera;
+		CameraKey pose = {(float)(getTime() - recordStart),
+				  c.Position, c.Yaw, c.Pitch};
+		if (CameraPath::appendKey(cameraPathFile, pose))
+			std::cout << "Camera pose recorded to "
+				  << cameraPathFile << std::endl;
+	}
 	if (key == GLFW_KEY_F && action == GLFW_PRESS) {
 		programState->spotLightEnabled =
 		    !programState->spotLightEnabled;
@@ -847,6 +2369,7 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action,
 }
 auto load2DTexture(char const *path) -> unsigned int
 {
+	CPU_ZONE("load2DTexture");
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
 
@@ -867,13 +2390,6 @@ auto load2DTexture(char const *path) -> unsigned int
 			     GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-				GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-				GL_LINEAR);
-
 		stbi_image_free(data);
 	} else {
 		std::cout << "Texture failed to load at path: " << path
@@ -885,6 +2401,7 @@ auto load2DTexture(char const *path) -> unsigned int
 }
 auto loadCubemap(vector<std::string> faces) -> unsigned int
 {
+	CPU_ZONE("loadCubemap");
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
@@ -905,14 +2422,6 @@ auto loadCubemap(vector<std::string> faces) -> unsigned int
 			stbi_image_free(data);
 		}
 	}
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S,
-			GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T,
-			GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R,
-			GL_CLAMP_TO_EDGE);
 	stbi_set_flip_vertically_on_load(true);
 
 	return textureID;